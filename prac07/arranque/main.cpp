@@ -0,0 +1,110 @@
+#include "../comun/CicloVida.h"
+#include "../eje01/Configuracion.h"
+#include "../eje02/Logger.h"
+#include "../eje03/ConexionBD.h"
+#include "../eje04/ControlJuego.h"
+#include "../eje05/LoggerThreadSafe.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+double msDesde(std::chrono::steady_clock::time_point inicio) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+// El Logger deja constancia del arranque con la zona horaria configurada
+void anunciarArranque() {
+    Logger::obtenerInstancia()->info("Arranque (zona horaria " +
+                                     Configuracion::obtenerInstancia()->getZonaHoraria() + ")");
+}
+
+void conectarBD() {
+    ConexionBD::obtenerInstancia()->conectar();
+    Logger::obtenerInstancia()->info("ConexionBD conectada");
+}
+
+void destruirTodos() {
+    ControlJuego::destruirInstancia();
+    ConexionBD::destruirInstancia();
+    LoggerThreadSafe::destruirInstancia();
+    Logger::destruirInstancia();
+    Configuracion::destruirInstancia();
+}
+
+// Cadena de obtenerInstancia() tal como ocurre hoy en la primera petición
+void arranqueEnSerie() {
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+    Configuracion::obtenerInstancia();
+    anunciarArranque();
+    LoggerThreadSafe::obtenerInstancia();
+    conectarBD();
+    ControlJuego::obtenerInstancia();
+    double total = msDesde(inicio);
+    
+    std::cout << "\n⏱️  Arranque en serie: ControlJuego listo a los " << std::fixed << std::setprecision(1)
+              << total << " ms, todo listo a los " << total << " ms\n";
+    destruirTodos();
+}
+
+// Solo se declaran las dependencias que usa de verdad cada arranque:
+// LoggerThreadSafe y ControlJuego no leen ni Configuracion ni Logger
+void registrarComponentes(GestorCicloVida* gestor) {
+    gestor->registrar("Configuracion", {},
+                      [] { Configuracion::obtenerInstancia(); },
+                      [] { Configuracion::destruirInstancia(); });
+    gestor->registrar("Logger", {"Configuracion"},
+                      [] { anunciarArranque(); },
+                      [] { Logger::destruirInstancia(); });
+    gestor->registrar("LoggerThreadSafe", {},
+                      [] { LoggerThreadSafe::obtenerInstancia(); },
+                      [] { LoggerThreadSafe::destruirInstancia(); });
+    // La conexión se establece durante el arranque, no en la primera consulta
+    gestor->registrar("ConexionBD", {"Logger"},
+                      [] { conectarBD(); },
+                      [] { ConexionBD::destruirInstancia(); });
+    gestor->registrar("ControlJuego", {},
+                      [] { ControlJuego::obtenerInstancia(); },
+                      [] { ControlJuego::destruirInstancia(); });
+}
+
+void arranqueEnParalelo() {
+    GestorCicloVida* gestor = GestorCicloVida::obtenerInstancia();
+    registrarComponentes(gestor);
+    
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+    gestor->arrancar();
+    gestor->esperar("ControlJuego");
+    double primeraPeticion = msDesde(inicio);
+    gestor->esperarTodos();
+    double total = msDesde(inicio);
+    
+    std::cout << "\n⏱️  Arranque en paralelo: ControlJuego listo a los " << std::fixed << std::setprecision(1)
+              << primeraPeticion << " ms, todo listo a los " << total << " ms\n\n";
+    gestor->imprimirReporte();
+    
+    std::cout << "\n📋 Parada en orden inverso de dependencias:\n";
+    gestor->detener();
+}
+
+int main() {
+    std::cout << std::string(80, '=') << "\n";
+    std::cout << "ARRANQUE ORDENADO DE SINGLETONS\n";
+    std::cout << std::string(80, '=') << "\n";
+    
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "1. ARRANQUE PEREZOSO EN SERIE\n";
+    std::cout << std::string(80, '=') << "\n";
+    arranqueEnSerie();
+    
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "2. ARRANQUE EN PARALELO CON DEPENDENCIAS\n";
+    std::cout << std::string(80, '=') << "\n";
+    arranqueEnParalelo();
+    
+    GestorCicloVida::destruirInstancia();
+    EntornoLatencia::destruirInstancia();
+    Rastreador::destruirInstancia();
+    RegistroLocks::destruirInstancia();
+    RegistroMetricas::destruirInstancia();
+    return 0;
+}
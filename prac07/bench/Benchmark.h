@@ -0,0 +1,183 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef BENCH_COMMIT
+#define BENCH_COMMIT "desconocido"
+#endif
+#ifndef BENCH_PERFIL
+#define BENCH_PERFIL "desconocido"
+#endif
+
+// Evita que el compilador elimine un cálculo cuyo resultado no se usa
+template <typename T>
+inline void noOptimizar(const T& valor) {
+    asm volatile("" : : "r,m"(valor) : "memory");
+}
+
+// Descarta lo que se escribe en std::cout mientras está vivo, pero deja que
+// el formateo ocurra: así se mide el coste real de la llamada sin la consola.
+class SilenciarSalida {
+private:
+    class BufferNulo : public std::streambuf {
+    protected:
+        int overflow(int c) { return c; }
+        std::streamsize xsputn(const char*, std::streamsize n) { return n; }
+    };
+    
+    BufferNulo nulo;
+    std::streambuf* previo;
+
+public:
+    SilenciarSalida() : previo(std::cout.rdbuf(&nulo)) {}
+    ~SilenciarSalida() { std::cout.rdbuf(previo); }
+};
+
+// Mini-framework al estilo de Google Benchmark: cada caso se repite con un
+// número creciente de iteraciones hasta superar el tiempo mínimo, y los
+// resultados se exportan en JSON para comparar ejecuciones entre commits.
+class SuiteBenchmarks {
+public:
+    // Recibe el número de iteraciones a ejecutar y el índice del hilo
+    typedef std::function<void(uint64_t, int)> Cuerpo;
+
+    struct Resultado {
+        std::string nombre;
+        int hilos;
+        uint64_t iteraciones;
+        double nsPorOp;
+        double opsPorSegundo;
+    };
+
+private:
+    std::string nombreSuite;
+    double tiempoMinimo;
+    // Flujo propio sobre la consola original, para que SilenciarSalida no
+    // oculte los resultados de la suite
+    std::ostream consola;
+    std::vector<Resultado> resultados;
+    
+    static double medir(const Cuerpo& cuerpo, uint64_t iteraciones, int hilos) {
+        typedef std::chrono::steady_clock Reloj;
+        if (hilos == 1) {
+            Reloj::time_point inicio = Reloj::now();
+            cuerpo(iteraciones, 0);
+            return std::chrono::duration<double>(Reloj::now() - inicio).count();
+        }
+        
+        std::atomic<int> listos(0);
+        std::atomic<bool> salida(false);
+        std::vector<std::thread> trabajadores;
+        for (int h = 0; h < hilos; h++) {
+            trabajadores.emplace_back([&, h] {
+                listos.fetch_add(1);
+                while (!salida.load(std::memory_order_acquire)) std::this_thread::yield();
+                cuerpo(iteraciones, h);
+            });
+        }
+        while (listos.load() < hilos) std::this_thread::yield();
+        Reloj::time_point inicio = Reloj::now();
+        salida.store(true, std::memory_order_release);
+        for (size_t i = 0; i < trabajadores.size(); i++) trabajadores[i].join();
+        return std::chrono::duration<double>(Reloj::now() - inicio).count();
+    }
+    
+    static std::string escaparJSON(const std::string& s) {
+        std::string r;
+        for (size_t i = 0; i < s.size(); i++) {
+            if (s[i] == '"' || s[i] == '\\') r += '\\';
+            r += s[i];
+        }
+        return r;
+    }
+
+public:
+    explicit SuiteBenchmarks(const std::string& nombre, double segundosMinimos = 0.2)
+        : nombreSuite(nombre), tiempoMinimo(segundosMinimos), consola(std::cout.rdbuf()) {}
+    
+    void ejecutar(const std::string& nombre, const Cuerpo& cuerpo,
+                  int hilos = 1, uint64_t maxIteraciones = 1000000000ULL) {
+        uint64_t iteraciones = 1;
+        double segundos = 0;
+        for (;;) {
+            segundos = medir(cuerpo, iteraciones, hilos);
+            if (segundos >= tiempoMinimo || iteraciones >= maxIteraciones) break;
+            // Estimar cuántas iteraciones llenan el tiempo mínimo (con margen)
+            double factor = segundos > 0 ? (tiempoMinimo * 1.4) / segundos : 100.0;
+            factor = std::min(std::max(factor, 2.0), 100.0);
+            iteraciones = std::min(static_cast<uint64_t>(iteraciones * factor), maxIteraciones);
+        }
+        
+        Resultado r;
+        r.nombre = nombre;
+        r.hilos = hilos;
+        r.iteraciones = iteraciones;
+        r.nsPorOp = segundos * 1e9 / static_cast<double>(iteraciones);
+        r.opsPorSegundo = static_cast<double>(iteraciones) * hilos / segundos;
+        resultados.push_back(r);
+        
+        consola << std::left << std::setw(48)
+                  << (nombre + (hilos > 1 ? "/hilos:" + std::to_string(hilos) : ""))
+                  << std::right << std::setw(14) << std::fixed << std::setprecision(1) << r.nsPorOp << " ns"
+                  << std::setw(16) << std::setprecision(0) << r.opsPorSegundo << " ops/s"
+                  << std::setw(12) << iteraciones << "\n";
+    }
+    
+    const std::vector<Resultado>& getResultados() const { return resultados; }
+    
+    bool exportarJSON(const std::string& ruta) const {
+        std::ofstream archivo(ruta, std::ios::trunc);
+        if (!archivo.is_open()) return false;
+        
+        time_t ahora = time(0);
+        struct tm tstruct;
+        char fecha[32];
+        localtime_r(&ahora, &tstruct);
+        strftime(fecha, sizeof(fecha), "%Y-%m-%dT%H:%M:%S", &tstruct);
+        
+        archivo << "{\n";
+        archivo << "  \"contexto\": {\n";
+        archivo << "    \"suite\": \"" << escaparJSON(nombreSuite) << "\",\n";
+        archivo << "    \"fecha\": \"" << fecha << "\",\n";
+        archivo << "    \"commit\": \"" << BENCH_COMMIT << "\",\n";
+        archivo << "    \"perfil\": \"" << BENCH_PERFIL << "\",\n";
+        archivo << "    \"cpus\": " << std::thread::hardware_concurrency() << "\n";
+        archivo << "  },\n";
+        archivo << "  \"benchmarks\": [\n";
+        archivo << std::setprecision(3) << std::fixed;
+        for (size_t i = 0; i < resultados.size(); i++) {
+            const Resultado& r = resultados[i];
+            archivo << "    {\"nombre\": \"" << escaparJSON(r.nombre) << "\""
+                    << ", \"hilos\": " << r.hilos
+                    << ", \"iteraciones\": " << r.iteraciones
+                    << ", \"ns_por_op\": " << r.nsPorOp
+                    << ", \"ops_por_segundo\": " << r.opsPorSegundo << "}"
+                    << (i + 1 < resultados.size() ? "," : "") << "\n";
+        }
+        archivo << "  ]\n}\n";
+        return archivo.good();
+    }
+};
+
+// Hilos a probar: 1, 2, 4, ... hasta max(4, núcleos disponibles)
+inline std::vector<int> nivelesDeHilos() {
+    int maximo = std::max(4u, std::thread::hardware_concurrency());
+    std::vector<int> niveles;
+    for (int h = 1; h <= maximo; h *= 2) niveles.push_back(h);
+    return niveles;
+}
+
+#endif
@@ -0,0 +1,68 @@
+// Benchmark: confirmaciones por segundo del diario de escrituras de eje03 con
+// un fdatasync por escritura frente a confirmación en grupo. Cada hilo hace
+// escrituras síncronas (espera su futuro antes de la siguiente), como una
+// transacción que no puede responder hasta estar en disco.
+// Uso: ./bench_diario [ruta del diario]   (por defecto en el directorio actual)
+#include "../eje03/DiarioEscrituras.h"
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const double SEGUNDOS_POR_CASO = 1.0;
+
+struct Resultado {
+    double porSegundo;
+    uint64_t escrituras;
+    uint64_t sincronizaciones;
+};
+
+Resultado medir(const std::string& ruta, PoliticaSincronizacion politica, int hilos) {
+    std::remove(ruta.c_str());
+    DiarioEscrituras diario(ruta, politica);
+    diario.abrir();
+    std::atomic<bool> parar(false);
+    std::vector<std::thread> escritores;
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+    for (int h = 0; h < hilos; h++) {
+        escritores.emplace_back([&diario, &parar, h] {
+            std::string registro = "INSERT INTO logs VALUES ('hilo " + std::to_string(h) + " evento de benchmark')";
+            while (!parar.load(std::memory_order_relaxed)) diario.anadir(registro).get();
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(SEGUNDOS_POR_CASO));
+    parar.store(true);
+    for (auto& escritor : escritores) escritor.join();
+    double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    Resultado r = {diario.getEscrituras() / segundos, diario.getEscrituras(), diario.getSincronizaciones()};
+    diario.cerrar();
+    std::remove(ruta.c_str());
+    return r;
+}
+
+int main(int argc, char* argv[]) {
+    std::string ruta = argc > 1 ? argv[1] : "bench_diario.wal";
+    std::cout << std::string(100, '=') << "\n";
+    std::cout << "DIARIO DE ESCRITURAS: FDATASYNC POR ESCRITURA VS CONFIRMACIÓN EN GRUPO (" << ruta << ")\n";
+    std::cout << std::string(100, '=') << "\n";
+    std::cout << std::left << std::setw(8) << "Hilos" << std::right
+              << std::setw(22) << "Por escritura /s" << std::setw(20) << "En grupo /s"
+              << std::setw(18) << "Esc./fsync" << std::setw(14) << "Mejora" << "\n";
+
+    const int niveles[] = {1, 2, 4, 8, 16, 32};
+    for (size_t i = 0; i < sizeof(niveles) / sizeof(niveles[0]); i++) {
+        Resultado individual = medir(ruta, SINCRONIZAR_CADA_ESCRITURA, niveles[i]);
+        Resultado grupo = medir(ruta, SINCRONIZAR_EN_GRUPO, niveles[i]);
+        double porGrupo = grupo.sincronizaciones > 0
+                        ? static_cast<double>(grupo.escrituras) / grupo.sincronizaciones : 0;
+        std::cout << std::left << std::setw(8) << niveles[i] << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(22) << individual.porSegundo << std::setw(20) << grupo.porSegundo
+                  << std::setw(18) << std::setprecision(1) << porGrupo
+                  << std::setw(13) << grupo.porSegundo / individual.porSegundo << "x\n";
+    }
+    RegistroMetricas::destruirInstancia();
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Benchmark: aparición/despacho de 1M enemigos e items por oleadas,
+// comparando el camino original (new + std::string por entidad) con
+// PoolEntidades + nombres internados.
+#include "../eje04/Entidades.h"
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+// Copia del Enemigo/Item original de eje04 (antes del pool)
+class EnemigoHeap {
+private:
+    static int contador;
+    std::string nombre;
+    int vida;
+    ControlJuego* control;
+    int puntosOtorgados;
+public:
+    EnemigoHeap(const std::string& tipo = "Básico")
+        : vida(100), control(ControlJuego::obtenerInstancia()) {
+        contador++;
+        nombre = tipo + " #" + std::to_string(contador);
+        puntosOtorgados = (tipo == "Básico") ? 50 : 150;
+    }
+    const std::string& getNombre() const { return nombre; }
+};
+
+int EnemigoHeap::contador = 0;
+
+class ItemHeap {
+private:
+    std::string nombre;
+    std::string tipo;
+    ControlJuego* control;
+public:
+    ItemHeap(const std::string& n, const std::string& t)
+        : nombre(n), tipo(t), control(ControlJuego::obtenerInstancia()) {}
+};
+
+static const int TOTAL = 1000000;
+static const int OLEADA = 1000;
+
+double medirHeap() {
+    std::vector<EnemigoHeap*> enemigos;
+    std::vector<ItemHeap*> items;
+    enemigos.reserve(OLEADA);
+    items.reserve(OLEADA);
+    auto inicio = std::chrono::steady_clock::now();
+    for (int o = 0; o < TOTAL / OLEADA; o++) {
+        for (int i = 0; i < OLEADA; i++) {
+            enemigos.push_back(new EnemigoHeap(i & 1 ? "Élite" : "Básico"));
+            items.push_back(new ItemHeap("Moneda de oro", "puntos"));
+        }
+        for (int i = 0; i < OLEADA; i++) {
+            delete enemigos[i];
+            delete items[i];
+        }
+        enemigos.clear();
+        items.clear();
+    }
+    auto fin = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(fin - inicio).count();
+}
+
+double medirPool() {
+    PoolEnemigos enemigos;
+    PoolItems items;
+    std::vector<Manejador> hEnemigos, hItems;
+    hEnemigos.reserve(OLEADA);
+    hItems.reserve(OLEADA);
+    const std::string basico("Básico"), elite("Élite"), moneda("Moneda de oro"), puntos("puntos");
+    auto inicio = std::chrono::steady_clock::now();
+    for (int o = 0; o < TOTAL / OLEADA; o++) {
+        for (int i = 0; i < OLEADA; i++) {
+            hEnemigos.push_back(enemigos.crear(i & 1 ? elite : basico));
+            hItems.push_back(items.crear(moneda, puntos));
+        }
+        for (int i = 0; i < OLEADA; i++) {
+            enemigos.destruir(hEnemigos[i]);
+            items.destruir(hItems[i]);
+        }
+        hEnemigos.clear();
+        hItems.clear();
+    }
+    auto fin = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(fin - inicio).count();
+}
+
+int main() {
+    ControlJuego::obtenerInstancia()->setSilencioso(true);
+    
+    double heap = medirHeap();
+    double pool = medirPool();
+    
+    std::cout << "Aparición/despacho de " << TOTAL << " enemigos + " << TOTAL
+              << " items (oleadas de " << OLEADA << ")\n";
+    std::cout << "  new + std::string : " << heap << " ms\n";
+    std::cout << "  PoolEntidades     : " << pool << " ms\n";
+    std::cout << "  Aceleración       : " << (heap / pool) << "x\n";
+    
+    TablaNombres::destruirInstancia();
+    ControlJuego::destruirInstancia();
+    return 0;
+}
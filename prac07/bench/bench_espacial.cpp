@@ -0,0 +1,107 @@
+// Benchmark: ataques en área y recogida de items con IndiceEspacial frente
+// al recorrido completo del pool, con enemigos que se mueven en cada tick.
+#include "../eje04/IndiceEspacial.h"
+#include "../eje04/GeneradorAleatorio.h"
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+static const float MUNDO = 1000.0f;
+static const float RADIO = 8.0f;
+static const float MEDIA_CAJA = 4.0f;
+static const int TICKS = 20;
+static const int CONSULTAS_POR_TICK = 1000;
+
+struct Resultado {
+    double ms;
+    long encontrados;
+};
+
+float coordenada(GeneradorAleatorio& g) {
+    return static_cast<float>(g.siguiente() >> 40) / static_cast<float>(1 << 24) * MUNDO;
+}
+
+// Paso aleatorio de hasta una unidad por eje
+void moverTodos(PoolEnemigos& enemigos, GeneradorAleatorio& g) {
+    enemigos.paraCada([&](Enemigo& e) {
+        Posicion p = e.getPosicion();
+        e.moverA(Posicion(p.x + static_cast<float>(g.rango(3) - 1), p.y + static_cast<float>(g.rango(3) - 1)));
+    });
+}
+
+Resultado medirFuerzaBruta(PoolEnemigos& enemigos, uint64_t semilla) {
+    GeneradorAleatorio g(semilla);
+    long encontrados = 0;
+    auto inicio = std::chrono::steady_clock::now();
+    for (int t = 0; t < TICKS; t++) {
+        moverTodos(enemigos, g);
+        for (int q = 0; q < CONSULTAS_POR_TICK; q++) {
+            Posicion c(coordenada(g), coordenada(g));
+            enemigos.paraCada([&](Enemigo& e) {
+                float dx = e.getPosicion().x - c.x, dy = e.getPosicion().y - c.y;
+                if (dx * dx + dy * dy <= RADIO * RADIO) encontrados++;
+            });
+            enemigos.paraCada([&](Enemigo& e) {
+                const Posicion& p = e.getPosicion();
+                if (p.x >= c.x - MEDIA_CAJA && p.x <= c.x + MEDIA_CAJA &&
+                    p.y >= c.y - MEDIA_CAJA && p.y <= c.y + MEDIA_CAJA) encontrados++;
+            });
+        }
+    }
+    auto fin = std::chrono::steady_clock::now();
+    Resultado r = {std::chrono::duration<double, std::milli>(fin - inicio).count(), encontrados};
+    return r;
+}
+
+Resultado medirIndice(PoolEnemigos& enemigos, uint64_t semilla) {
+    GeneradorAleatorio g(semilla);
+    IndiceEspacial indice(RADIO, 1 << 14);
+    long encontrados = 0;
+    auto inicio = std::chrono::steady_clock::now();
+    for (int t = 0; t < TICKS; t++) {
+        moverTodos(enemigos, g);
+        indice.sincronizar(enemigos);
+        for (int q = 0; q < CONSULTAS_POR_TICK; q++) {
+            Posicion c(coordenada(g), coordenada(g));
+            indice.enRadio(c, RADIO, [&](Manejador, Posicion) { encontrados++; });
+            indice.enCaja(Posicion(c.x - MEDIA_CAJA, c.y - MEDIA_CAJA), Posicion(c.x + MEDIA_CAJA, c.y + MEDIA_CAJA),
+                          [&](Manejador, Posicion) { encontrados++; });
+        }
+    }
+    auto fin = std::chrono::steady_clock::now();
+    Resultado r = {std::chrono::duration<double, std::milli>(fin - inicio).count(), encontrados};
+    return r;
+}
+
+void poblar(PoolEnemigos& enemigos, int n) {
+    GeneradorAleatorio g(12345);
+    const std::string basico("Básico");
+    for (int i = 0; i < n; i++) enemigos.crear(basico, Posicion(coordenada(g), coordenada(g)));
+}
+
+int main() {
+    ControlJuego::obtenerInstancia()->setSilencioso(true);
+
+    std::cout << TICKS << " ticks; por tick todos se mueven y se hacen " << CONSULTAS_POR_TICK
+              << " consultas de radio " << RADIO << " + " << CONSULTAS_POR_TICK
+              << " de caja " << 2 * MEDIA_CAJA << "x" << 2 * MEDIA_CAJA << " (mundo " << MUNDO << "x" << MUNDO << ")\n";
+    const int tamanos[] = {1000, 10000, 50000};
+    for (size_t i = 0; i < sizeof(tamanos) / sizeof(tamanos[0]); i++) {
+        // Pools nuevos: mismo orden de ranuras, mismos movimientos en ambos
+        PoolEnemigos paraBruta, paraIndice;
+        poblar(paraBruta, tamanos[i]);
+        poblar(paraIndice, tamanos[i]);
+        Resultado bruta = medirFuerzaBruta(paraBruta, 99);
+        Resultado indice = medirIndice(paraIndice, 99);
+
+        std::cout << "\n" << tamanos[i] << " enemigos\n";
+        std::cout << "  Recorrido completo : " << bruta.ms / TICKS << " ms/tick (" << bruta.encontrados << " aciertos)\n";
+        std::cout << "  IndiceEspacial     : " << indice.ms / TICKS << " ms/tick (" << indice.encontrados << " aciertos)\n";
+        std::cout << "  Aceleración        : " << (bruta.ms / indice.ms) << "x"
+                  << (bruta.encontrados == indice.encontrados ? "" : "  ❌ resultados distintos") << "\n";
+    }
+
+    TablaNombres::destruirInstancia();
+    ControlJuego::destruirInstancia();
+    return 0;
+}
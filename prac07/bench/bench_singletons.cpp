@@ -0,0 +1,219 @@
+// Suite de microbenchmarks de los singletons de la práctica.
+// Uso: ./bench_singletons [resultados.json]
+#include "Benchmark.h"
+#include "../eje01/Configuracion.h"
+#include "../eje02/Logger.h"
+#include "../eje03/ConexionBD.h"
+#include "../eje04/ControlJuego.h"
+#include "../eje05/LoggerThreadSafe.h"
+#include "../eje05/ConexionBDThreadSafe.h"
+
+int main(int argc, char* argv[]) {
+    std::string rutaJSON = argc > 1 ? argv[1] : "resultados_singletons.json";
+    SuiteBenchmarks suite("singletons");
+    std::vector<int> hilos = nivelesDeHilos();
+    
+    std::cout << std::string(100, '=') << "\n";
+    std::cout << "BENCHMARKS DE SINGLETONS\n";
+    std::cout << std::string(100, '=') << "\n";
+    
+    // ---- Coste de obtenerInstancia() ----
+    suite.ejecutar("Configuracion::obtenerInstancia", [](uint64_t n, int) {
+        for (uint64_t i = 0; i < n; i++) noOptimizar(Configuracion::obtenerInstancia());
+    });
+    suite.ejecutar("Logger::obtenerInstancia", [](uint64_t n, int) {
+        for (uint64_t i = 0; i < n; i++) noOptimizar(Logger::obtenerInstancia());
+    });
+    suite.ejecutar("ConexionBD::obtenerInstancia", [](uint64_t n, int) {
+        SilenciarSalida silencio;
+        for (uint64_t i = 0; i < n; i++) noOptimizar(ConexionBD::obtenerInstancia());
+    });
+    {
+        SilenciarSalida silencio;
+        ControlJuego::obtenerInstancia()->setSilencioso(true);
+    }
+    suite.ejecutar("ControlJuego::obtenerInstancia", [](uint64_t n, int) {
+        for (uint64_t i = 0; i < n; i++) noOptimizar(ControlJuego::obtenerInstancia());
+    });
+    for (size_t h = 0; h < hilos.size(); h++) {
+        suite.ejecutar("LoggerThreadSafe::obtenerInstancia", [](uint64_t n, int) {
+            for (uint64_t i = 0; i < n; i++) noOptimizar(LoggerThreadSafe::obtenerInstancia());
+        }, hilos[h]);
+    }
+    for (size_t h = 0; h < hilos.size(); h++) {
+        suite.ejecutar("ConexionBDThreadSafe::obtenerInstancia", [](uint64_t n, int) {
+            for (uint64_t i = 0; i < n; i++) noOptimizar(ConexionBDThreadSafe::obtenerInstancia());
+        }, hilos[h]);
+    }
+    
+    // ---- Coste de un span con el trazado desactivado ----
+    suite.ejecutar("TRAZA_SPAN (desactivado)", [](uint64_t n, int) {
+        for (uint64_t i = 0; i < n; i++) {
+            TRAZA_SPAN("bench", "bench");
+            noOptimizar(i);
+        }
+    });
+    
+    // ---- Coste de los locks: std::mutex vs MutexPerfilado (bloqueante/adaptativo) ----
+    {
+        static std::mutex mutexPlano;
+        static MutexPerfilado mutexBloqueante("bench::bloqueante");
+        static MutexPerfilado mutexAdaptativo("bench::adaptativo", true);
+        static uint64_t contador = 0;
+        for (size_t h = 0; h < hilos.size(); h++) {
+            suite.ejecutar("std::mutex contador++", [](uint64_t n, int) {
+                for (uint64_t i = 0; i < n; i++) {
+                    std::lock_guard<std::mutex> lock(mutexPlano);
+                    contador++;
+                }
+            }, hilos[h]);
+            suite.ejecutar("MutexPerfilado contador++", [](uint64_t n, int) {
+                for (uint64_t i = 0; i < n; i++) {
+                    std::lock_guard<MutexPerfilado> lock(mutexBloqueante);
+                    contador++;
+                }
+            }, hilos[h]);
+            suite.ejecutar("MutexPerfilado(adaptativo) contador++", [](uint64_t n, int) {
+                for (uint64_t i = 0; i < n; i++) {
+                    std::lock_guard<MutexPerfilado> lock(mutexAdaptativo);
+                    contador++;
+                }
+            }, hilos[h]);
+        }
+    }
+    
+    // ---- Coste de registrar métricas (fragmento por hilo vs atómico compartido) ----
+    {
+        static const Contador contadorBench("bench_contador_total", "Contador de benchmark");
+        static const Histograma histogramaBench("bench_latencia_segundos", "Histograma de benchmark");
+        static std::atomic<uint64_t> compartido(0);
+        for (size_t h = 0; h < hilos.size(); h++) {
+            suite.ejecutar("std::atomic fetch_add compartido", [](uint64_t n, int) {
+                for (uint64_t i = 0; i < n; i++) compartido.fetch_add(1, std::memory_order_relaxed);
+            }, hilos[h]);
+            suite.ejecutar("Contador::incrementar", [](uint64_t n, int) {
+                for (uint64_t i = 0; i < n; i++) contadorBench.incrementar();
+            }, hilos[h]);
+            suite.ejecutar("Histograma::observar", [](uint64_t n, int) {
+                for (uint64_t i = 0; i < n; i++) histogramaBench.observar(i & 0xFFFFF);
+            }, hilos[h]);
+        }
+    }
+    
+    // ---- Throughput de log (sin límite de frecuencia: cada línea llega al archivo) ----
+    Logger::obtenerInstancia()->setLimiteFrecuencia(0, 0);
+    LoggerThreadSafe::obtenerInstancia()->setLimiteFrecuencia(0, 0);
+    suite.ejecutar("Logger::log", [](uint64_t n, int) {
+        SilenciarSalida silencio;
+        Logger* logger = Logger::obtenerInstancia();
+        for (uint64_t i = 0; i < n; i++) logger->log("Mensaje de benchmark", "INFO");
+    });
+    for (size_t h = 0; h < hilos.size(); h++) {
+        SilenciarSalida silencio;
+        suite.ejecutar("LoggerThreadSafe::log", [](uint64_t n, int hilo) {
+            LoggerThreadSafe* logger = LoggerThreadSafe::obtenerInstancia();
+            std::string mensaje = "Hilo " + std::to_string(hilo) + " - mensaje de benchmark";
+            for (uint64_t i = 0; i < n; i++) logger->log(mensaje, "INFO");
+        }, hilos[h]);
+    }
+    
+    // ---- Tormenta de errores desde un mismo sitio, con el límite por defecto ----
+    Logger::obtenerInstancia()->setLimiteFrecuencia(20, 5);
+    LoggerThreadSafe::obtenerInstancia()->setLimiteFrecuencia(20, 5);
+    suite.ejecutar("Logger::error (tormenta, limitado)", [](uint64_t n, int) {
+        SilenciarSalida silencio;
+        Logger* logger = Logger::obtenerInstancia();
+        for (uint64_t i = 0; i < n; i++) logger->error("Error de sintaxis en la query", LOG_SITIO);
+    });
+    for (size_t h = 0; h < hilos.size(); h++) {
+        SilenciarSalida silencio;
+        suite.ejecutar("LoggerThreadSafe::error (tormenta, limitado)", [](uint64_t n, int) {
+            LoggerThreadSafe* logger = LoggerThreadSafe::obtenerInstancia();
+            for (uint64_t i = 0; i < n; i++) logger->error("Timeout al leer pedidos", LOG_SITIO);
+        }, hilos[h]);
+    }
+    
+    // ---- Throughput de consultas ----
+    // Salvo que LATENCIA_RELOJ diga lo contrario, la latencia simulada corre
+    // sobre el reloj virtual: se mide solo el coste de CPU de cada consulta.
+    if (std::getenv("LATENCIA_RELOJ") == nullptr) {
+        EntornoLatencia::obtenerInstancia()->usarRelojVirtual();
+    }
+    {
+        SilenciarSalida silencio;
+        ConexionBD::obtenerInstancia()->conectar();
+        ConexionBDThreadSafe::obtenerInstancia()->conectar();
+    }
+    suite.ejecutar("ConexionBD::ejecutarConsulta", [](uint64_t n, int) {
+        SilenciarSalida silencio;
+        ConexionBD* bd = ConexionBD::obtenerInstancia();
+        for (uint64_t i = 0; i < n; i++) noOptimizar(bd->ejecutarConsulta("SELECT * FROM usuarios"));
+    });
+    for (size_t h = 0; h < hilos.size(); h++) {
+        SilenciarSalida silencio;
+        suite.ejecutar("ConexionBDThreadSafe::ejecutarConsulta", [](uint64_t n, int) {
+            ConexionBDThreadSafe* bd = ConexionBDThreadSafe::obtenerInstancia();
+            for (uint64_t i = 0; i < n; i++) noOptimizar(bd->ejecutarConsulta("SELECT * FROM tabla"));
+        }, hilos[h]);
+    }
+    
+    // ---- Materializar 1000 filas: arena por resultado vs un std::string por celda ----
+    suite.ejecutar("ResultadoConsulta 1000 filas (arena)", [](uint64_t n, int) {
+        TablaSimulada tabla = TablaSimulada::desdeConsulta("SELECT * FROM usuarios LIMIT 1000");
+        for (uint64_t i = 0; i < n; i++) {
+            ResultadoConsulta resultado;
+            tabla.llenar(resultado, 0, tabla.getNumFilas());
+            noOptimizar(resultado.getNumFilas());
+        }
+    });
+    suite.ejecutar("vector<vector<string>> 1000 filas", [](uint64_t n, int) {
+        TablaSimulada tabla = TablaSimulada::desdeConsulta("SELECT * FROM usuarios LIMIT 1000");
+        char celda[TablaSimulada::MAX_CELDA];
+        for (uint64_t i = 0; i < n; i++) {
+            std::vector<std::vector<std::string> > filas;
+            for (long f = 0; f < tabla.getNumFilas(); f++) {
+                std::vector<std::string> fila;
+                for (size_t c = 0; c < tabla.getColumnas().size(); c++) {
+                    fila.push_back(std::string(celda, tabla.escribirCelda(f, c, celda)));
+                }
+                filas.push_back(std::move(fila));
+            }
+            noOptimizar(filas.size());
+        }
+    });
+    
+    // ---- Tasa de mutación de ControlJuego ----
+    ControlJuego::obtenerInstancia()->iniciarJuego();
+    suite.ejecutar("ControlJuego::sumarPuntos", [](uint64_t n, int) {
+        ControlJuego* control = ControlJuego::obtenerInstancia();
+        for (uint64_t i = 0; i < n; i++) control->sumarPuntos(1);
+    });
+    suite.ejecutar("ControlJuego::registrarEnemigoEliminado", [](uint64_t n, int) {
+        ControlJuego* control = ControlJuego::obtenerInstancia();
+        for (uint64_t i = 0; i < n; i++) control->registrarEnemigoEliminado();
+    });
+    suite.ejecutar("ControlJuego::tomarInstantanea", [](uint64_t n, int) {
+        ControlJuego* control = ControlJuego::obtenerInstancia();
+        for (uint64_t i = 0; i < n; i++) noOptimizar(control->tomarInstantanea());
+    });
+    
+    {
+        SilenciarSalida silencio;
+        ConexionBD::obtenerInstancia()->desconectar();
+    }
+    std::cout << "\n📄 Resultados JSON: " << rutaJSON << "\n";
+    suite.exportarJSON(rutaJSON);
+    
+    Configuracion::destruirInstancia();
+    Logger::destruirInstancia();
+    ConexionBD::destruirInstancia();
+    ControlJuego::destruirInstancia();
+    LoggerThreadSafe::destruirInstancia();
+    ConexionBDThreadSafe::destruirInstancia();
+    EntornoLatencia::destruirInstancia();
+    Rastreador::destruirInstancia();
+    RegistroLocks::obtenerInstancia()->imprimirReporte();
+    RegistroLocks::destruirInstancia();
+    RegistroMetricas::destruirInstancia();
+    return 0;
+}
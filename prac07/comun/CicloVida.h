@@ -0,0 +1,253 @@
+#ifndef CICLOVIDA_H
+#define CICLOVIDA_H
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Traza.h"
+
+// ---------------------------------------------------------------------------
+// Gestor del ciclo de vida de los singletons (Singleton thread-safe).
+//
+// Cada componente declara sus dependencias, una función de arranque (crear
+// la instancia y hacer el trabajo de calentamiento, p. ej. conectar) y una de
+// parada (normalmente destruirInstancia()).
+//
+// - arrancar() lanza cada componente en su propio hilo en cuanto terminan
+//   sus dependencias: los independientes arrancan en paralelo y no bloquea
+//   al llamador.
+// - esperar(nombre) bloquea solo hasta que ese componente está listo, así la
+//   primera petición no paga el arranque de lo que no usa.
+// - detener() espera el arranque y para los componentes en orden inverso al
+//   que terminaron de arrancar (cada uno antes que sus dependencias).
+// ---------------------------------------------------------------------------
+class GestorCicloVida {
+private:
+    struct Componente {
+        std::string nombre;
+        std::vector<std::string> dependencias;
+        std::function<void()> iniciar;
+        std::function<void()> destruir;
+        std::promise<void> promesa;
+        std::shared_future<void> listo;
+        double inicioMs;
+        double finMs;
+        bool fallo;
+    };
+
+    static std::atomic<GestorCicloVida*> instancia;
+    static std::mutex mutexInstancia;
+
+    std::mutex mutexComponentes;
+    std::map<std::string, std::unique_ptr<Componente> > componentes;
+    std::vector<std::string> ordenRegistro;
+    std::vector<Componente*> ordenArranque;     // orden en que terminaron
+    std::vector<std::thread> hilos;
+    std::chrono::steady_clock::time_point origen;
+    bool arrancado;
+
+    GestorCicloVida() : arrancado(false) {}
+
+    GestorCicloVida(const GestorCicloVida&) = delete;
+    GestorCicloVida& operator=(const GestorCicloVida&) = delete;
+
+    double msDesdeOrigen() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - origen).count();
+    }
+
+    // Dependencias inexistentes o ciclos; devuelve el orden topológico
+    bool validar(std::vector<Componente*>& orden) {
+        std::map<std::string, int> marca;   // 0 sin visitar, 1 en curso, 2 hecho
+        std::function<bool(Componente*)> visitar = [&](Componente* c) {
+            int& m = marca[c->nombre];
+            if (m == 2) return true;
+            if (m == 1) {
+                std::cout << "❌ Dependencia circular en '" << c->nombre << "'\n";
+                return false;
+            }
+            m = 1;
+            for (size_t i = 0; i < c->dependencias.size(); i++) {
+                std::map<std::string, std::unique_ptr<Componente> >::iterator it =
+                    componentes.find(c->dependencias[i]);
+                if (it == componentes.end()) {
+                    std::cout << "❌ '" << c->nombre << "' depende de '" << c->dependencias[i]
+                              << "', que no está registrado\n";
+                    return false;
+                }
+                if (!visitar(it->second.get())) return false;
+            }
+            marca[c->nombre] = 2;
+            orden.push_back(c);
+            return true;
+        };
+        for (size_t i = 0; i < ordenRegistro.size(); i++) {
+            if (!visitar(componentes[ordenRegistro[i]].get())) return false;
+        }
+        return true;
+    }
+
+    void arrancarComponente(Componente* c) {
+        std::vector<std::shared_future<void> > previas;
+        {
+            std::lock_guard<std::mutex> lock(mutexComponentes);
+            for (size_t i = 0; i < c->dependencias.size(); i++) {
+                previas.push_back(componentes[c->dependencias[i]]->listo);
+            }
+        }
+        try {
+            for (size_t i = 0; i < previas.size(); i++) previas[i].get();
+            c->inicioMs = msDesdeOrigen();
+            {
+                TRAZA_SPAN("GestorCicloVida::iniciarComponente", "arranque");
+                c->iniciar();
+            }
+            c->finMs = msDesdeOrigen();
+            {
+                std::lock_guard<std::mutex> lock(mutexComponentes);
+                ordenArranque.push_back(c);
+            }
+            c->promesa.set_value();
+        } catch (...) {
+            c->fallo = true;
+            c->finMs = msDesdeOrigen();
+            c->promesa.set_exception(std::current_exception());
+        }
+    }
+
+public:
+    static GestorCicloVida* obtenerInstancia() {
+        GestorCicloVida* actual = instancia.load(std::memory_order_acquire);
+        if (actual == nullptr) {
+            std::lock_guard<std::mutex> lock(mutexInstancia);
+            actual = instancia.load(std::memory_order_relaxed);
+            if (actual == nullptr) {
+                actual = new GestorCicloVida();
+                instancia.store(actual, std::memory_order_release);
+            }
+        }
+        return actual;
+    }
+
+    bool registrar(const std::string& nombre, const std::vector<std::string>& dependencias,
+                   std::function<void()> iniciar, std::function<void()> destruir) {
+        std::lock_guard<std::mutex> lock(mutexComponentes);
+        if (arrancado || componentes.count(nombre) > 0) {
+            std::cout << "❌ No se puede registrar '" << nombre << "'\n";
+            return false;
+        }
+        std::unique_ptr<Componente> c(new Componente());
+        c->nombre = nombre;
+        c->dependencias = dependencias;
+        c->iniciar = iniciar;
+        c->destruir = destruir;
+        c->listo = c->promesa.get_future().share();
+        c->inicioMs = c->finMs = 0;
+        c->fallo = false;
+        componentes[nombre] = std::move(c);
+        ordenRegistro.push_back(nombre);
+        return true;
+    }
+
+    // Lanza el arranque en segundo plano; false si el grafo no es válido
+    bool arrancar() {
+        std::vector<Componente*> orden;
+        {
+            std::lock_guard<std::mutex> lock(mutexComponentes);
+            if (arrancado) return true;
+            if (!validar(orden)) return false;
+            arrancado = true;
+            origen = std::chrono::steady_clock::now();
+        }
+        for (size_t i = 0; i < orden.size(); i++) {
+            hilos.emplace_back(&GestorCicloVida::arrancarComponente, this, orden[i]);
+        }
+        return true;
+    }
+
+    // Bloquea hasta que `nombre` (y por tanto sus dependencias) está listo;
+    // relanza la excepción si su arranque falló
+    void esperar(const std::string& nombre) {
+        std::shared_future<void> listo;
+        {
+            std::lock_guard<std::mutex> lock(mutexComponentes);
+            std::map<std::string, std::unique_ptr<Componente> >::iterator it = componentes.find(nombre);
+            if (it == componentes.end()) return;
+            listo = it->second->listo;
+        }
+        listo.get();
+    }
+
+    // Espera a todos; false si alguno falló
+    bool esperarTodos() {
+        bool correcto = true;
+        for (size_t i = 0; i < ordenRegistro.size(); i++) {
+            try {
+                esperar(ordenRegistro[i]);
+            } catch (const std::exception& e) {
+                std::cout << "❌ Falló el arranque de '" << ordenRegistro[i] << "': " << e.what() << "\n";
+                correcto = false;
+            } catch (...) {
+                std::cout << "❌ Falló el arranque de '" << ordenRegistro[i] << "'\n";
+                correcto = false;
+            }
+        }
+        return correcto;
+    }
+
+    double getMsDesdeArranque() const { return msDesdeOrigen(); }
+
+    // Tiempos de cada componente; llamar tras esperarTodos()
+    void imprimirReporte() {
+        std::lock_guard<std::mutex> lock(mutexComponentes);
+        std::cout << std::left << std::setw(18) << "Componente" << std::setw(34) << "Depende de"
+                  << std::right << std::setw(12) << "Inicio ms" << std::setw(12) << "Listo ms" << "\n";
+        for (size_t i = 0; i < ordenRegistro.size(); i++) {
+            const Componente& c = *componentes[ordenRegistro[i]];
+            std::string deps;
+            for (size_t d = 0; d < c.dependencias.size(); d++) deps += (d > 0 ? ", " : "") + c.dependencias[d];
+            std::cout << std::left << std::setw(18) << c.nombre << std::setw(34) << (deps.empty() ? "-" : deps)
+                      << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(12) << c.inicioMs << std::setw(12) << c.finMs
+                      << (c.fallo ? "  ❌" : "") << "\n";
+        }
+    }
+
+    // Para en orden inverso de arranque y deja el gestor listo para otro ciclo
+    void detener() {
+        esperarTodos();
+        for (size_t i = 0; i < hilos.size(); i++) hilos[i].join();
+        hilos.clear();
+
+        std::lock_guard<std::mutex> lock(mutexComponentes);
+        for (size_t i = ordenArranque.size(); i-- > 0;) {
+            std::cout << "🛑 Parando '" << ordenArranque[i]->nombre << "'\n";
+            ordenArranque[i]->destruir();
+        }
+        ordenArranque.clear();
+        componentes.clear();
+        ordenRegistro.clear();
+        arrancado = false;
+    }
+
+    static void destruirInstancia() {
+        std::lock_guard<std::mutex> lock(mutexInstancia);
+        GestorCicloVida* actual = instancia.exchange(nullptr);
+        if (actual != nullptr) actual->detener();
+        delete actual;
+    }
+};
+
+std::atomic<GestorCicloVida*> GestorCicloVida::instancia(nullptr);
+std::mutex GestorCicloVida::mutexInstancia;
+
+#endif
@@ -0,0 +1,276 @@
+#ifndef CORRUTINAS_H
+#define CORRUTINAS_H
+
+// Corrutinas C++20 sobre un planificador de un solo hilo. Con estándares
+// anteriores el archivo queda vacío (ver `make eje03-corrutinas`).
+#if defined(__cpp_impl_coroutine)
+
+#include <algorithm>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <new>
+#include <optional>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "ModeloLatencia.h"
+
+// ---------------------------------------------------------------------------
+// Contabilidad de marcos: cada corrutina reserva su estado en el heap; así se
+// puede comparar su coste con la pila de un hilo por petición.
+// ---------------------------------------------------------------------------
+struct EstadisticasMarcos {
+    static inline std::size_t creados = 0;
+    static inline std::size_t vivos = 0;
+    static inline std::size_t bytesVivos = 0;
+    static inline std::size_t bytesPico = 0;
+};
+
+struct PromesaContada {
+    static void* operator new(std::size_t bytes) {
+        void* memoria = ::operator new(bytes);
+        EstadisticasMarcos::creados++;
+        EstadisticasMarcos::vivos++;
+        EstadisticasMarcos::bytesVivos += bytes;
+        EstadisticasMarcos::bytesPico = std::max(EstadisticasMarcos::bytesPico,
+                                                 EstadisticasMarcos::bytesVivos);
+        return memoria;
+    }
+
+    static void operator delete(void* memoria, std::size_t bytes) {
+        EstadisticasMarcos::vivos--;
+        EstadisticasMarcos::bytesVivos -= bytes;
+        ::operator delete(memoria);
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Tarea<T>: corrutina perezosa que se arranca al hacer co_await sobre ella y,
+// al terminar, reanuda a quien la esperaba (transferencia simétrica).
+// ---------------------------------------------------------------------------
+template <typename T> class Tarea;
+
+struct PromesaTareaBase : PromesaContada {
+    std::coroutine_handle<> continuacion;
+    std::exception_ptr excepcion;
+
+    struct AlTerminar {
+        bool await_ready() const noexcept { return false; }
+
+        template <typename Promesa>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promesa> h) noexcept {
+            std::coroutine_handle<> siguiente = h.promise().continuacion;
+            return siguiente ? siguiente : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    AlTerminar final_suspend() const noexcept { return {}; }
+    void unhandled_exception() { excepcion = std::current_exception(); }
+};
+
+template <typename T>
+struct PromesaTarea : PromesaTareaBase {
+    std::optional<T> valor;
+
+    Tarea<T> get_return_object();
+    void return_value(T v) { valor = std::move(v); }
+
+    T resultado() {
+        if (excepcion) std::rethrow_exception(excepcion);
+        return std::move(*valor);
+    }
+};
+
+template <>
+struct PromesaTarea<void> : PromesaTareaBase {
+    Tarea<void> get_return_object();
+    void return_void() {}
+
+    void resultado() {
+        if (excepcion) std::rethrow_exception(excepcion);
+    }
+};
+
+template <typename T>
+class Tarea {
+public:
+    typedef PromesaTarea<T> promise_type;
+
+private:
+    std::coroutine_handle<promise_type> manejador;
+
+public:
+    explicit Tarea(std::coroutine_handle<promise_type> h) : manejador(h) {}
+    Tarea(Tarea&& otra) noexcept : manejador(std::exchange(otra.manejador, nullptr)) {}
+    Tarea(const Tarea&) = delete;
+    Tarea& operator=(const Tarea&) = delete;
+
+    ~Tarea() {
+        if (manejador) manejador.destroy();
+    }
+
+    struct Espera {
+        std::coroutine_handle<promise_type> manejador;
+
+        bool await_ready() const noexcept { return manejador.done(); }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> quienEspera) noexcept {
+            manejador.promise().continuacion = quienEspera;
+            return manejador;
+        }
+
+        T await_resume() { return manejador.promise().resultado(); }
+    };
+
+    Espera operator co_await() const noexcept { return Espera{manejador}; }
+};
+
+template <typename T>
+Tarea<T> PromesaTarea<T>::get_return_object() {
+    return Tarea<T>(std::coroutine_handle<PromesaTarea<T> >::from_promise(*this));
+}
+
+inline Tarea<void> PromesaTarea<void>::get_return_object() {
+    return Tarea<void>(std::coroutine_handle<PromesaTarea<void> >::from_promise(*this));
+}
+
+// ---------------------------------------------------------------------------
+// Planificador de un solo hilo (Singleton). Mantiene una cola de corrutinas
+// listas y otra de temporizadores; cuando no queda nada listo espera en el
+// reloj del EntornoLatencia hasta el siguiente vencimiento, de modo que con
+// LATENCIA_RELOJ=virtual el bucle avanza sin dormir.
+// ---------------------------------------------------------------------------
+class PlanificadorCorrutinas {
+private:
+    static PlanificadorCorrutinas* instancia;
+
+    struct Temporizador {
+        Duracion instante;
+        unsigned long orden;          // desempate FIFO para el mismo instante
+        std::coroutine_handle<> manejador;
+
+        bool operator>(const Temporizador& otro) const {
+            return instante != otro.instante ? instante > otro.instante : orden > otro.orden;
+        }
+    };
+
+    // Envoltorio que arranca una Tarea lanzada y se autodestruye al acabar
+    struct TareaDesacoplada {
+        struct promise_type : PromesaContada {
+            TareaDesacoplada get_return_object() {
+                return TareaDesacoplada{std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            std::suspend_never final_suspend() const noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+        std::coroutine_handle<promise_type> manejador;
+    };
+
+    std::deque<std::coroutine_handle<> > listas;
+    std::priority_queue<Temporizador, std::vector<Temporizador>, std::greater<Temporizador> > temporizadores;
+    unsigned long siguienteOrden;
+    std::size_t enVuelo;
+    std::size_t picoEnVuelo;
+
+    PlanificadorCorrutinas() : siguienteOrden(0), enVuelo(0), picoEnVuelo(0) {}
+
+    PlanificadorCorrutinas(const PlanificadorCorrutinas&) = delete;
+    PlanificadorCorrutinas& operator=(const PlanificadorCorrutinas&) = delete;
+
+    static TareaDesacoplada conducir(Tarea<void> tarea, PlanificadorCorrutinas* planificador) {
+        co_await tarea;
+        planificador->enVuelo--;
+    }
+
+    static Reloj& reloj() { return EntornoLatencia::obtenerInstancia()->getReloj(); }
+
+public:
+    static PlanificadorCorrutinas* obtenerInstancia() {
+        if (instancia == nullptr) {
+            instancia = new PlanificadorCorrutinas();
+        }
+        return instancia;
+    }
+
+    // Añade una petición lógica; empieza a ejecutarse dentro de ejecutar()
+    void lanzar(Tarea<void> tarea) {
+        enVuelo++;
+        picoEnVuelo = std::max(picoEnVuelo, enVuelo);
+        listas.push_back(conducir(std::move(tarea), this).manejador);
+    }
+
+    void reanudarLuego(std::coroutine_handle<> h) {
+        listas.push_back(h);
+    }
+
+    void reanudarTras(Duracion demora, std::coroutine_handle<> h) {
+        temporizadores.push(Temporizador{reloj().ahora() + demora, siguienteOrden++, h});
+    }
+
+    // Corre hasta que todas las tareas lanzadas terminan
+    void ejecutar() {
+        while (!listas.empty() || !temporizadores.empty()) {
+            while (!listas.empty()) {
+                std::coroutine_handle<> h = listas.front();
+                listas.pop_front();
+                h.resume();
+            }
+            if (temporizadores.empty()) break;
+
+            Duracion ahora = reloj().ahora();
+            if (temporizadores.top().instante > ahora) {
+                reloj().esperar(temporizadores.top().instante - ahora);
+                ahora = reloj().ahora();
+            }
+            while (!temporizadores.empty() && temporizadores.top().instante <= ahora) {
+                listas.push_back(temporizadores.top().manejador);
+                temporizadores.pop();
+            }
+        }
+    }
+
+    std::size_t getEnVuelo() const { return enVuelo; }
+    std::size_t getPicoEnVuelo() const { return picoEnVuelo; }
+    void reiniciarPico() { picoEnVuelo = enVuelo; }
+
+    static void destruirInstancia() {
+        if (instancia != nullptr) {
+            delete instancia;
+            instancia = nullptr;
+        }
+    }
+};
+
+inline PlanificadorCorrutinas* PlanificadorCorrutinas::instancia = nullptr;
+
+// Operación con latencia simulada: suspende la corrutina durante `demora` en
+// el planificador y, al reanudarse, devuelve lo que produzca `alCompletar`.
+template <typename T>
+class EsperaSimulada {
+private:
+    Duracion demora;
+    std::function<T()> alCompletar;
+
+public:
+    EsperaSimulada(Duracion d, std::function<T()> f) : demora(d), alCompletar(std::move(f)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> h) {
+        PlanificadorCorrutinas::obtenerInstancia()->reanudarTras(demora, h);
+    }
+
+    T await_resume() { return alCompletar(); }
+};
+
+#endif // __cpp_impl_coroutine
+
+#endif
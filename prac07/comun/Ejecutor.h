@@ -0,0 +1,259 @@
+#ifndef EJECUTOR_H
+#define EJECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+
+enum Prioridad {
+    PRIORIDAD_ALTA = 0,
+    PRIORIDAD_NORMAL = 1,
+    PRIORIDAD_BAJA = 2,
+    NUM_PRIORIDADES = 3
+};
+
+// Cola de un trabajador: una deque por prioridad. El dueño saca del final
+// (LIFO, datos aún en caché) y los demás roban del principio (FIFO).
+class ColaTrabajo {
+private:
+    std::mutex mutexCola;
+    std::deque<std::function<void()> > tareas[NUM_PRIORIDADES];
+
+public:
+    void agregar(std::function<void()> tarea, Prioridad p) {
+        std::lock_guard<std::mutex> lock(mutexCola);
+        tareas[p].push_back(std::move(tarea));
+    }
+    
+    bool sacarPropia(std::function<void()>& tarea) {
+        std::lock_guard<std::mutex> lock(mutexCola);
+        for (int p = 0; p < NUM_PRIORIDADES; p++) {
+            if (!tareas[p].empty()) {
+                tarea = std::move(tareas[p].back());
+                tareas[p].pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    bool robar(std::function<void()>& tarea, int prioridad) {
+        std::unique_lock<std::mutex> lock(mutexCola, std::try_to_lock);
+        if (!lock.owns_lock() || tareas[prioridad].empty()) return false;
+        tarea = std::move(tareas[prioridad].front());
+        tareas[prioridad].pop_front();
+        return true;
+    }
+};
+
+// Pool de hilos único del proceso con robo de trabajo (Singleton thread-safe).
+//
+// - Una cola por trabajador (uno por núcleo por defecto); las tareas enviadas
+//   desde un trabajador van a su propia cola, las externas en round-robin.
+// - Un trabajador sin tareas roba de los demás, de mayor a menor prioridad.
+// - EJECUTOR_HILOS=<n> fija el número de trabajadores y EJECUTOR_FIJAR_CPU=1
+//   fija el trabajador i al núcleo i (pthread_setaffinity_np).
+// - destruirInstancia() drena todas las tareas pendientes antes de parar.
+class Ejecutor {
+private:
+    static std::atomic<Ejecutor*> instancia;
+    static std::mutex mutexInstancia;
+    
+    std::vector<std::unique_ptr<ColaTrabajo> > colas;
+    std::vector<std::thread> trabajadores;
+    std::atomic<unsigned> siguienteCola;
+    std::atomic<bool> detenido;
+    bool fijarCPU;
+    
+    // Tareas enviadas y aún no terminadas (para drenar), tareas en cola sin
+    // tomar y trabajadores dormidos (para despertar solo cuando hace falta)
+    std::atomic<long> pendientes;
+    std::atomic<long> encoladas;
+    std::atomic<int> dormidos;
+    std::mutex mutexEspera;
+    std::condition_variable hayTrabajo;
+    std::condition_variable sinPendientes;
+    
+    std::atomic<unsigned long> ejecutadas;
+    std::atomic<unsigned long> robadas;
+    
+    static int& indiceTrabajadorActual() {
+        static thread_local int indice = -1;
+        return indice;
+    }
+    
+    explicit Ejecutor(unsigned numHilos, bool fijar)
+        : siguienteCola(0), detenido(false), fijarCPU(fijar),
+          pendientes(0), encoladas(0), dormidos(0), ejecutadas(0), robadas(0) {
+        for (unsigned i = 0; i < numHilos; i++) {
+            colas.push_back(std::unique_ptr<ColaTrabajo>(new ColaTrabajo()));
+        }
+        for (unsigned i = 0; i < numHilos; i++) {
+            trabajadores.emplace_back(&Ejecutor::bucleTrabajador, this, i);
+        }
+    }
+    
+    Ejecutor(const Ejecutor&) = delete;
+    Ejecutor& operator=(const Ejecutor&) = delete;
+    
+    static unsigned hilosPorDefecto() {
+        const char* valor = std::getenv("EJECUTOR_HILOS");
+        if (valor != nullptr && std::atoi(valor) > 0) return static_cast<unsigned>(std::atoi(valor));
+        unsigned n = std::thread::hardware_concurrency();
+        return n > 0 ? n : 1;
+    }
+    
+    void fijarAlNucleo(unsigned indice) {
+        cpu_set_t conjunto;
+        CPU_ZERO(&conjunto);
+        CPU_SET(indice % std::thread::hardware_concurrency(), &conjunto);
+        pthread_setaffinity_np(pthread_self(), sizeof(conjunto), &conjunto);
+    }
+    
+    bool buscarTarea(unsigned propio, std::function<void()>& tarea) {
+        if (colas[propio]->sacarPropia(tarea)) {
+            encoladas.fetch_sub(1);
+            return true;
+        }
+        for (int p = 0; p < NUM_PRIORIDADES; p++) {
+            for (size_t k = 1; k < colas.size(); k++) {
+                if (colas[(propio + k) % colas.size()]->robar(tarea, p)) {
+                    encoladas.fetch_sub(1);
+                    robadas.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+    
+    void terminarTarea() {
+        ejecutadas.fetch_add(1, std::memory_order_relaxed);
+        if (pendientes.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(mutexEspera);
+            sinPendientes.notify_all();
+        }
+    }
+    
+    void bucleTrabajador(unsigned indice) {
+        indiceTrabajadorActual() = static_cast<int>(indice);
+        if (fijarCPU) fijarAlNucleo(indice);
+        
+        std::function<void()> tarea;
+        for (;;) {
+            if (buscarTarea(indice, tarea)) {
+                tarea();
+                tarea = nullptr;
+                terminarTarea();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutexEspera);
+            if (detenido.load() && pendientes.load() == 0) return;
+            // dormidos y encoladas son seq_cst: o enviar() ve a este hilo
+            // dormido y notifica, o este hilo ve la tarea nueva y no duerme
+            dormidos.fetch_add(1);
+            hayTrabajo.wait(lock, [this] { return encoladas.load() > 0 || detenido.load(); });
+            dormidos.fetch_sub(1);
+        }
+    }
+
+public:
+    static Ejecutor* obtenerInstancia() {
+        Ejecutor* actual = instancia.load(std::memory_order_acquire);
+        if (actual == nullptr) {
+            std::lock_guard<std::mutex> lock(mutexInstancia);
+            actual = instancia.load(std::memory_order_relaxed);
+            if (actual == nullptr) {
+                const char* fijar = std::getenv("EJECUTOR_FIJAR_CPU");
+                actual = new Ejecutor(hilosPorDefecto(), fijar != nullptr && std::string(fijar) == "1");
+                instancia.store(actual, std::memory_order_release);
+            }
+        }
+        return actual;
+    }
+    
+    void enviar(std::function<void()> tarea, Prioridad prioridad = PRIORIDAD_NORMAL) {
+        pendientes.fetch_add(1, std::memory_order_acq_rel);
+        int propio = indiceTrabajadorActual();
+        unsigned destino = propio >= 0
+            ? static_cast<unsigned>(propio)
+            : siguienteCola.fetch_add(1, std::memory_order_relaxed) % colas.size();
+        colas[destino]->agregar(std::move(tarea), prioridad);
+        encoladas.fetch_add(1);
+        if (dormidos.load() > 0) {
+            std::lock_guard<std::mutex> lock(mutexEspera);
+            hayTrabajo.notify_one();
+        }
+    }
+    
+    // Envía una función con resultado; el future también propaga excepciones
+    template <typename F>
+    std::future<typename std::result_of<F()>::type> enviarConResultado(F funcion,
+                                                                       Prioridad prioridad = PRIORIDAD_NORMAL) {
+        typedef typename std::result_of<F()>::type Tipo;
+        std::shared_ptr<std::packaged_task<Tipo()> > tarea =
+            std::make_shared<std::packaged_task<Tipo()> >(std::move(funcion));
+        std::future<Tipo> resultado = tarea->get_future();
+        enviar([tarea] { (*tarea)(); }, prioridad);
+        return resultado;
+    }
+    
+    // Bloquea hasta que no quede ninguna tarea pendiente (incluidas las que
+    // se envíen mientras tanto). No debe llamarse desde un trabajador.
+    void drenar() {
+        std::unique_lock<std::mutex> lock(mutexEspera);
+        sinPendientes.wait(lock, [this] { return pendientes.load() == 0; });
+    }
+    
+    // Para los singletons que encolan tareas con su `this`: antes de
+    // borrarse esperan a que terminen. No crea el Ejecutor si no existe, y
+    // desde un trabajador no espera (se bloquearía a sí mismo).
+    static void drenarSiExiste() {
+        Ejecutor* actual = instancia.load(std::memory_order_acquire);
+        if (actual != nullptr && !actual->esTrabajador()) actual->drenar();
+    }
+    
+    unsigned getNumHilos() const { return static_cast<unsigned>(trabajadores.size()); }
+    unsigned long getEjecutadas() const { return ejecutadas.load(); }
+    unsigned long getRobadas() const { return robadas.load(); }
+    bool esTrabajador() const { return indiceTrabajadorActual() >= 0; }
+    
+    // Drena con la instancia aún publicada y sin mutexInstancia: una tarea
+    // pendiente puede llamar a obtenerInstancia() (p. ej. logAsync) sin
+    // bloquearse ni crear un Ejecutor nuevo.
+    static void destruirInstancia() {
+        Ejecutor* actual = instancia.load(std::memory_order_acquire);
+        if (actual == nullptr) return;
+        actual->drenar();
+        {
+            std::lock_guard<std::mutex> lock(mutexInstancia);
+            if (instancia.load(std::memory_order_relaxed) != actual) return;
+            instancia.store(nullptr, std::memory_order_release);
+        }
+        // Lo enviado entre el primer drenado y la retirada
+        actual->drenar();
+        {
+            std::lock_guard<std::mutex> lockEspera(actual->mutexEspera);
+            actual->detenido = true;
+        }
+        actual->hayTrabajo.notify_all();
+        for (size_t i = 0; i < actual->trabajadores.size(); i++) actual->trabajadores[i].join();
+        delete actual;
+    }
+};
+
+std::atomic<Ejecutor*> Ejecutor::instancia(nullptr);
+std::mutex Ejecutor::mutexInstancia;
+
+#endif
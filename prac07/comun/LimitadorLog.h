@@ -0,0 +1,226 @@
+#ifndef LIMITADORLOG_H
+#define LIMITADORLOG_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <type_traits>
+
+// ---------------------------------------------------------------------------
+// Límite de frecuencia por sitio de llamada para Logger y LoggerThreadSafe.
+//
+// Cada clave (hash de archivo:línea + nivel) tiene un cubo de fichas: admite
+// ráfagas de `rafaga` líneas y después `porSegundo` líneas por segundo. Lo que
+// no cabe se descarta antes de formatear y antes del mutex de escritura, y se
+// cuenta; la siguiente línea admitida de esa clave lleva el
+// "[mensaje repetido N veces]".
+//
+//     logger->error("Error de sintaxis en la query", LOG_SITIO);
+//
+// Sin LOG_SITIO la clave es el hash del mensaje, así que también se agrupan
+// las repeticiones idénticas. LOG_RAFAGA / LOG_POR_SEGUNDO cambian los
+// límites; LOG_RAFAGA=0 lo desactiva.
+// ---------------------------------------------------------------------------
+
+// FNV-1a evaluable en compilación (C++11: una sola expresión return)
+constexpr uint64_t hashFNV(const char* texto, uint64_t hash = 14695981039346656037ULL) {
+    return *texto == '\0' ? hash
+                          : hashFNV(texto + 1, (hash ^ static_cast<unsigned char>(*texto)) * 1099511628211ULL);
+}
+
+constexpr uint64_t hashSitio(const char* archivo, int linea) {
+    return (hashFNV(archivo) ^ static_cast<uint64_t>(linea)) * 1099511628211ULL;
+}
+
+struct SitioLog {
+    uint64_t hash;    // 0 = sin sitio
+    constexpr SitioLog() : hash(0) {}
+    constexpr explicit SitioLog(uint64_t h) : hash(h) {}
+};
+
+// integral_constant obliga a calcular el hash al compilar
+#define LOG_SITIO SitioLog(std::integral_constant<uint64_t, hashSitio(__FILE__, __LINE__)>::value)
+
+class LimitadorLog {
+private:
+    static const size_t NUM_CONJUNTOS = 64;    // potencia de 2
+    static const size_t VIAS = 4;
+    static const size_t FANTASMAS = 16;
+
+    // Tabla asociativa por conjuntos: cada clave puede ocupar cualquiera de
+    // las VIAS entradas de su conjunto y, si están todas ocupadas, se expulsa
+    // la usada hace más tiempo. La expulsada pasa a una de las FANTASMAS
+    // entradas "fantasma" del conjunto (en círculo) con sus fichas y sus
+    // repeticiones: si vuelve, las recupera, así que alternar más claves
+    // calientes que vías no da ráfagas nuevas mientras quepan en vías y
+    // fantasmas (20 por conjunto). Solo cuando se pisa un fantasma sus
+    // repeticiones pasan al total sin resumen.
+    struct Entrada {
+        uint64_t clave;          // 0 = libre
+        double fichas;
+        std::chrono::steady_clock::time_point ultimaRecarga;   // también es el último uso
+        unsigned long repetidas;
+        Entrada() : clave(0), fichas(0), repetidas(0) {}
+    };
+
+    // Una clave que no está ni en las vías ni en los fantasmas escribe
+    // siempre su primera línea, así que los mensajes distintos y poco
+    // frecuentes entran todos. Si expulsa a otra, el resto de su ráfaga sale
+    // del cubo de desborde del conjunto, que se recarga al ritmo de una clave.
+    struct Conjunto {
+        std::mutex mutex;
+        Entrada vias[VIAS];
+        Entrada fantasmas[FANTASMAS];
+        size_t siguienteFantasma;
+        Entrada desborde;        // clave sin uso
+        Conjunto() : siguienteFantasma(0) {}
+    };
+
+    Conjunto conjuntos[NUM_CONJUNTOS];
+    std::atomic<double> rafaga;
+    std::atomic<double> porSegundo;
+    std::atomic<unsigned long> admitidas;
+    std::atomic<unsigned long> suprimidas;
+    std::atomic<unsigned long> sinResumen;
+
+    static double leerEntorno(const char* variable, double porDefecto) {
+        const char* valor = std::getenv(variable);
+        return valor != nullptr ? std::atof(valor) : porDefecto;
+    }
+
+    static uint64_t mezclar(uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    static void recargar(Entrada& e, std::chrono::steady_clock::time_point ahora,
+                         double capacidad, double ritmo) {
+        e.fichas += std::chrono::duration<double>(ahora - e.ultimaRecarga).count() * ritmo;
+        if (e.fichas > capacidad) e.fichas = capacidad;
+        e.ultimaRecarga = ahora;
+    }
+
+    // Llamar con el mutex del conjunto tomado. Mete la clave en `victima`
+    // (libre o la LRU) y devuelve la entrada lista para recargar.
+    Entrada* ocupar(Conjunto& c, Entrada& victima, uint64_t claveLinea,
+                    std::chrono::steady_clock::time_point ahora, double capacidad, double ritmo) {
+        bool expulsa = victima.clave != 0;
+        for (size_t i = 0; i < FANTASMAS; i++) {
+            if (c.fantasmas[i].clave == claveLinea) {
+                // Intercambio: la clave vuelve con su estado y la expulsada
+                // ocupa su hueco
+                Entrada vuelve = c.fantasmas[i];
+                c.fantasmas[i] = victima;
+                victima = vuelve;
+                return &victima;
+            }
+        }
+        if (expulsa) {
+            Entrada& fantasma = c.fantasmas[c.siguienteFantasma];
+            c.siguienteFantasma = (c.siguienteFantasma + 1) % FANTASMAS;
+            if (fantasma.clave != 0 && fantasma.repetidas > 0) {
+                sinResumen.fetch_add(fantasma.repetidas, std::memory_order_relaxed);
+            }
+            fantasma = victima;
+        }
+        victima.clave = claveLinea;
+        victima.ultimaRecarga = ahora;
+        victima.repetidas = 0;
+        if (!expulsa) {
+            victima.fichas = capacidad;
+        } else {
+            // Empieza lleno: su ultimaRecarga inicial es el origen del reloj
+            recargar(c.desborde, ahora, capacidad, ritmo);
+            double fichas = c.desborde.fichas < capacidad ? c.desborde.fichas : capacidad;
+            if (fichas < 1.0) fichas = 1.0;
+            c.desborde.fichas -= fichas;
+            if (c.desborde.fichas < 0) c.desborde.fichas = 0;
+            victima.fichas = fichas;
+        }
+        return &victima;
+    }
+
+public:
+    LimitadorLog()
+        : rafaga(leerEntorno("LOG_RAFAGA", 20)), porSegundo(leerEntorno("LOG_POR_SEGUNDO", 5)),
+          admitidas(0), suprimidas(0), sinResumen(0) {}
+
+    LimitadorLog(const LimitadorLog&) = delete;
+    LimitadorLog& operator=(const LimitadorLog&) = delete;
+
+    static uint64_t clave(SitioLog sitio, const std::string& nivel, const std::string& mensaje) {
+        uint64_t base = sitio.hash != 0 ? sitio.hash : std::hash<std::string>()(mensaje);
+        return mezclar(base ^ hashFNV(nivel.c_str()));
+    }
+
+    // rafaga = 0 desactiva el límite
+    void configurar(double fichasRafaga, double fichasPorSegundo) {
+        rafaga.store(fichasRafaga, std::memory_order_relaxed);
+        porSegundo.store(fichasPorSegundo, std::memory_order_relaxed);
+    }
+
+    // true si la línea se escribe; `repetidas` son las suprimidas de esa
+    // clave desde la última que se escribió
+    bool admitir(uint64_t claveLinea, unsigned long& repetidas) {
+        repetidas = 0;
+        double capacidad = rafaga.load(std::memory_order_relaxed);
+        if (capacidad <= 0) {
+            admitidas.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        std::chrono::steady_clock::time_point ahora = std::chrono::steady_clock::now();
+        Conjunto& c = conjuntos[claveLinea & (NUM_CONJUNTOS - 1)];
+        std::lock_guard<std::mutex> lock(c.mutex);
+        Entrada* encontrada = nullptr;
+        Entrada* victima = &c.vias[0];
+        for (size_t i = 0; i < VIAS; i++) {
+            if (c.vias[i].clave == claveLinea) {
+                encontrada = &c.vias[i];
+                break;
+            }
+            if (c.vias[i].clave == 0) {
+                if (victima->clave != 0) victima = &c.vias[i];
+            } else if (victima->clave != 0 && c.vias[i].ultimaRecarga < victima->ultimaRecarga) {
+                victima = &c.vias[i];
+            }
+        }
+        double ritmo = porSegundo.load(std::memory_order_relaxed);
+        if (encontrada == nullptr) encontrada = ocupar(c, *victima, claveLinea, ahora, capacidad, ritmo);
+        recargar(*encontrada, ahora, capacidad, ritmo);
+        Entrada& r = *encontrada;
+        if (r.fichas < 1.0) {
+            r.repetidas++;
+            suprimidas.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        r.fichas -= 1.0;
+        repetidas = r.repetidas;
+        r.repetidas = 0;
+        admitidas.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Repeticiones que nunca llegaron a resumirse (sin línea admitida después)
+    unsigned long pendientes() {
+        unsigned long total = sinResumen.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < NUM_CONJUNTOS; i++) {
+            std::lock_guard<std::mutex> lock(conjuntos[i].mutex);
+            for (size_t v = 0; v < VIAS; v++) total += conjuntos[i].vias[v].repetidas;
+            for (size_t f = 0; f < FANTASMAS; f++) {
+                if (conjuntos[i].fantasmas[f].clave != 0) total += conjuntos[i].fantasmas[f].repetidas;
+            }
+        }
+        return total;
+    }
+
+    unsigned long getAdmitidas() const { return admitidas.load(std::memory_order_relaxed); }
+    unsigned long getSuprimidas() const { return suprimidas.load(std::memory_order_relaxed); }
+};
+
+#endif
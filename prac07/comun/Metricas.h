@@ -0,0 +1,610 @@
+#ifndef METRICAS_H
+#define METRICAS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Histograma log-lineal al estilo HDR: valores enteros (nanosegundos) con
+// 16 subcubetas por potencia de 2, error relativo < 6.25 %. Exacto hasta 15;
+// lo que pase de 2^44 ns (~4.9 h) cae en la última cubeta.
+struct EscalaHistograma {
+    static const int BITS_SUB = 4;
+    static const uint64_t SUB = 1 << BITS_SUB;
+    static const int EXPONENTE_MAX = 43;
+    static const size_t NUM_CUBETAS = (EXPONENTE_MAX - BITS_SUB + 2) * SUB;
+
+    static size_t cubeta(uint64_t v) {
+        if (v < SUB) return static_cast<size_t>(v);
+        int e = 63 - __builtin_clzll(v);
+        if (e > EXPONENTE_MAX) return NUM_CUBETAS - 1;
+        return static_cast<size_t>((e - BITS_SUB + 1) * SUB + ((v >> (e - BITS_SUB)) & (SUB - 1)));
+    }
+
+    // Mayor valor que cae en la cubeta i
+    static uint64_t limiteSuperior(size_t i) {
+        if (i < SUB) return i;
+        int e = static_cast<int>(i / SUB) + BITS_SUB - 1;
+        uint64_t inferior = (SUB + i % SUB) << (e - BITS_SUB);
+        return inferior + (uint64_t(1) << (e - BITS_SUB)) - 1;
+    }
+};
+
+// Cubetas de un histograma en un hilo: solo ese hilo escribe
+struct HistogramaLocal {
+    std::atomic<uint64_t> cubetas[EscalaHistograma::NUM_CUBETAS];
+    std::atomic<uint64_t> suma;
+    std::atomic<uint64_t> cantidad;
+
+    HistogramaLocal() : suma(0), cantidad(0) {
+        for (size_t i = 0; i < EscalaHistograma::NUM_CUBETAS; i++) cubetas[i].store(0, std::memory_order_relaxed);
+    }
+};
+
+// Suma de los HistogramaLocal de todos los hilos, con sus percentiles
+struct ResumenHistograma {
+    std::vector<uint64_t> cubetas;
+    uint64_t suma;
+    uint64_t cantidad;
+
+    ResumenHistograma() : cubetas(EscalaHistograma::NUM_CUBETAS, 0), suma(0), cantidad(0) {}
+
+    uint64_t percentil(double q) const {
+        if (cantidad == 0) return 0;
+        uint64_t objetivo = static_cast<uint64_t>(q * cantidad);
+        if (objetivo < 1) objetivo = 1;
+        uint64_t acumulado = 0;
+        for (size_t i = 0; i < cubetas.size(); i++) {
+            acumulado += cubetas[i];
+            if (acumulado >= objetivo) return EscalaHistograma::limiteSuperior(i);
+        }
+        return EscalaHistograma::limiteSuperior(cubetas.size() - 1);
+    }
+
+    // Valores <= limite (por cubetas completas)
+    uint64_t hasta(uint64_t limite) const {
+        uint64_t total = 0;
+        for (size_t i = 0; i < cubetas.size() && EscalaHistograma::limiteSuperior(i) <= limite; i++) {
+            total += cubetas[i];
+        }
+        return total;
+    }
+};
+
+enum TipoMetrica {
+    METRICA_CONTADOR,
+    METRICA_MEDIDOR,
+    METRICA_HISTOGRAMA
+};
+
+// ---------------------------------------------------------------------------
+// Registro central de métricas (Singleton thread-safe).
+//
+// - Contadores e histogramas se escriben en un fragmento por hilo (como los
+//   buffers de Traza.h): una carga y un store relajados, sin RMW ni locks.
+//   Al exportar se suman los fragmentos vivos más el acumulado `retirado`:
+//   cuando un hilo termina, su fragmento se suma ahí y se libera, así que
+//   la memoria y el coste de exportar no crecen con los hilos que ya se fueron.
+// - Los medidores (gauges) son un único atómico compartido.
+// - exportarTexto() genera el formato de texto de Prometheus. Los nombres
+//   pueden llevar etiquetas: "prac07_bd_consultas_total{clase=\"ConexionBD\"}".
+// - METRICAS_PUERTO=<n> sirve /metrics en 127.0.0.1:<n>;
+//   METRICAS_ARCHIVO=<ruta> lo vuelca cada METRICAS_INTERVALO_MS (1000 ms).
+// ---------------------------------------------------------------------------
+class RegistroMetricas {
+public:
+    static const uint32_t MAX_CONTADORES = 128;
+    static const uint32_t MAX_HISTOGRAMAS = 32;
+    static const uint32_t MAX_MEDIDORES = 64;
+    static const uint32_t SIN_METRICA = 0xFFFFFFFF;
+
+private:
+    struct Fragmento {
+        std::atomic<uint64_t> contadores[MAX_CONTADORES];
+        std::atomic<HistogramaLocal*> histogramas[MAX_HISTOGRAMAS];
+        std::vector<std::unique_ptr<HistogramaLocal> > propios;
+
+        Fragmento() {
+            for (uint32_t i = 0; i < MAX_CONTADORES; i++) contadores[i].store(0, std::memory_order_relaxed);
+            for (uint32_t i = 0; i < MAX_HISTOGRAMAS; i++) histogramas[i].store(nullptr, std::memory_order_relaxed);
+        }
+    };
+
+    struct Definicion {
+        std::string nombre;       // con etiquetas, si las hay
+        std::string ayuda;
+        TipoMetrica tipo;
+        uint32_t id;              // índice dentro de su tipo
+    };
+
+    static std::atomic<RegistroMetricas*> instancia;
+    static std::mutex mutexInstancia;
+    static std::atomic<uint64_t> contadorInstancias;
+
+    uint64_t idInstancia;
+    std::mutex mutexDefiniciones;
+    std::vector<Definicion> definiciones;
+    uint32_t numPorTipo[3];
+    std::atomic<int64_t> medidores[MAX_MEDIDORES];
+
+    std::mutex mutexFragmentos;
+    std::vector<std::unique_ptr<Fragmento> > fragmentos;
+    Fragmento retirado;           // suma de los fragmentos de hilos terminados
+
+    std::thread hiloExportacion;
+    std::atomic<bool> exportando;
+    int socketEscucha;
+    std::string archivoVolcado;
+    std::chrono::milliseconds intervaloVolcado;
+
+    RegistroMetricas() : idInstancia(contadorInstancias.fetch_add(1) + 1), exportando(false),
+                         socketEscucha(-1), intervaloVolcado(1000) {
+        numPorTipo[0] = numPorTipo[1] = numPorTipo[2] = 0;
+        for (uint32_t i = 0; i < MAX_MEDIDORES; i++) medidores[i].store(0, std::memory_order_relaxed);
+    }
+
+    RegistroMetricas(const RegistroMetricas&) = delete;
+    RegistroMetricas& operator=(const RegistroMetricas&) = delete;
+
+    // Fragmento cacheado por el hilo; al terminar el hilo lo retira
+    struct FragmentoHilo {
+        Fragmento* fragmento;
+        uint64_t propietario;
+        FragmentoHilo() : fragmento(nullptr), propietario(0) {}
+        ~FragmentoHilo() {
+            if (fragmento != nullptr) retirarFragmento(propietario, fragmento);
+        }
+    };
+
+    Fragmento* fragmentoDelHilo() {
+        // El id de instancia invalida el fragmento cacheado si el registro se recrea
+        // (el anterior ya se liberó con su registro)
+        static thread_local FragmentoHilo hilo;
+        if (hilo.propietario != idInstancia) {
+            std::lock_guard<std::mutex> lock(mutexFragmentos);
+            fragmentos.push_back(std::unique_ptr<Fragmento>(new Fragmento()));
+            hilo.fragmento = fragmentos.back().get();
+            hilo.propietario = idInstancia;
+        }
+        return hilo.fragmento;
+    }
+
+    // Suma el fragmento en `retirado` y lo libera. mutexInstancia impide que
+    // el registro se destruya a la vez; si ya no es el de ese fragmento, el
+    // fragmento murió con su registro y no hay nada que hacer.
+    static void retirarFragmento(uint64_t propietario, Fragmento* fragmento) {
+        std::lock_guard<std::mutex> lockInstancia(mutexInstancia);
+        RegistroMetricas* actual = instancia.load(std::memory_order_acquire);
+        if (actual == nullptr || actual->idInstancia != propietario) return;
+        std::lock_guard<std::mutex> lock(actual->mutexFragmentos);
+        actual->acumular(*fragmento);
+        for (size_t f = 0; f < actual->fragmentos.size(); f++) {
+            if (actual->fragmentos[f].get() == fragmento) {
+                actual->fragmentos[f].swap(actual->fragmentos.back());
+                actual->fragmentos.pop_back();
+                break;
+            }
+        }
+    }
+
+    // Con mutexFragmentos; el hilo dueño de `origen` ya no escribe
+    void acumular(const Fragmento& origen) {
+        for (uint32_t i = 0; i < MAX_CONTADORES; i++) {
+            sumarLocal(retirado.contadores[i], origen.contadores[i].load(std::memory_order_relaxed));
+        }
+        for (uint32_t id = 0; id < MAX_HISTOGRAMAS; id++) {
+            const HistogramaLocal* h = origen.histogramas[id].load(std::memory_order_acquire);
+            if (h == nullptr) continue;
+            HistogramaLocal* destino = retirado.histogramas[id].load(std::memory_order_relaxed);
+            if (destino == nullptr) {
+                retirado.propios.push_back(std::unique_ptr<HistogramaLocal>(new HistogramaLocal()));
+                destino = retirado.propios.back().get();
+                retirado.histogramas[id].store(destino, std::memory_order_relaxed);
+            }
+            for (size_t i = 0; i < EscalaHistograma::NUM_CUBETAS; i++) {
+                sumarLocal(destino->cubetas[i], h->cubetas[i].load(std::memory_order_relaxed));
+            }
+            sumarLocal(destino->suma, h->suma.load(std::memory_order_relaxed));
+            sumarLocal(destino->cantidad, h->cantidad.load(std::memory_order_relaxed));
+        }
+    }
+
+    static void sumarLocal(std::atomic<uint64_t>& celda, uint64_t n) {
+        celda.store(celda.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    uint64_t totalContador(uint32_t id) {
+        uint64_t total = retirado.contadores[id].load(std::memory_order_relaxed);
+        for (size_t f = 0; f < fragmentos.size(); f++) {
+            total += fragmentos[f]->contadores[id].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    ResumenHistograma totalHistograma(uint32_t id) {
+        ResumenHistograma r;
+        for (size_t f = 0; f <= fragmentos.size(); f++) {
+            const Fragmento& fragmento = f < fragmentos.size() ? *fragmentos[f] : retirado;
+            HistogramaLocal* h = fragmento.histogramas[id].load(std::memory_order_acquire);
+            if (h == nullptr) continue;
+            for (size_t i = 0; i < EscalaHistograma::NUM_CUBETAS; i++) {
+                r.cubetas[i] += h->cubetas[i].load(std::memory_order_relaxed);
+            }
+            r.suma += h->suma.load(std::memory_order_relaxed);
+            r.cantidad += h->cantidad.load(std::memory_order_relaxed);
+        }
+        return r;
+    }
+
+    // "nombre{a=\"b\"}" -> familia "nombre", etiquetas "a=\"b\""
+    static void separar(const std::string& nombre, std::string& familia, std::string& etiquetas) {
+        size_t llave = nombre.find('{');
+        if (llave == std::string::npos) {
+            familia = nombre;
+            etiquetas.clear();
+        } else {
+            familia = nombre.substr(0, llave);
+            etiquetas = nombre.substr(llave + 1, nombre.size() - llave - 2);
+        }
+    }
+
+    static std::string conEtiquetas(const std::string& familia, const std::string& etiquetas,
+                                    const std::string& extra = "") {
+        std::string todas = etiquetas;
+        if (!extra.empty()) todas += (todas.empty() ? "" : ",") + extra;
+        return todas.empty() ? familia : familia + "{" + todas + "}";
+    }
+
+    uint32_t registrar(const std::string& nombre, const std::string& ayuda, TipoMetrica tipo) {
+        std::lock_guard<std::mutex> lock(mutexDefiniciones);
+        for (size_t i = 0; i < definiciones.size(); i++) {
+            if (definiciones[i].nombre == nombre) {
+                return definiciones[i].tipo == tipo ? definiciones[i].id : SIN_METRICA;
+            }
+        }
+        const uint32_t maximos[3] = {MAX_CONTADORES, MAX_MEDIDORES, MAX_HISTOGRAMAS};
+        if (numPorTipo[tipo] >= maximos[tipo]) return SIN_METRICA;
+        Definicion d;
+        d.nombre = nombre;
+        d.ayuda = ayuda;
+        d.tipo = tipo;
+        d.id = numPorTipo[tipo]++;
+        definiciones.push_back(d);
+        return d.id;
+    }
+
+    // Atiende una petición HTTP/1.0: GET /metrics (o /) devuelve el texto
+    void atenderPeticion(int cliente) {
+        char peticion[1024];
+        ssize_t leidos = 0;
+        struct pollfd espera = {cliente, POLLIN, 0};
+        if (poll(&espera, 1, 500) > 0) leidos = recv(cliente, peticion, sizeof(peticion) - 1, 0);
+        peticion[leidos > 0 ? leidos : 0] = '\0';
+
+        bool valida = std::strncmp(peticion, "GET /metrics", 12) == 0 || std::strncmp(peticion, "GET / ", 6) == 0;
+        std::string cuerpo = valida ? exportarTexto() : "No encontrado\n";
+        std::ostringstream respuesta;
+        respuesta << (valida ? "HTTP/1.0 200 OK\r\n" : "HTTP/1.0 404 Not Found\r\n")
+                  << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                  << "Content-Length: " << cuerpo.size() << "\r\nConnection: close\r\n\r\n" << cuerpo;
+        std::string datos = respuesta.str();
+        size_t enviados = 0;
+        while (enviados < datos.size()) {
+            ssize_t n = send(cliente, datos.data() + enviados, datos.size() - enviados, MSG_NOSIGNAL);
+            if (n <= 0) break;
+            enviados += static_cast<size_t>(n);
+        }
+        close(cliente);
+    }
+
+    void bucleExportacion() {
+        std::chrono::steady_clock::time_point proximoVolcado = std::chrono::steady_clock::now() + intervaloVolcado;
+        while (exportando.load(std::memory_order_acquire)) {
+            if (socketEscucha >= 0) {
+                struct pollfd escucha = {socketEscucha, POLLIN, 0};
+                if (poll(&escucha, 1, 100) > 0) {
+                    int cliente = accept(socketEscucha, nullptr, nullptr);
+                    if (cliente >= 0) atenderPeticion(cliente);
+                }
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            if (!archivoVolcado.empty() && std::chrono::steady_clock::now() >= proximoVolcado) {
+                volcar(archivoVolcado);
+                proximoVolcado += intervaloVolcado;
+            }
+        }
+    }
+
+public:
+    static RegistroMetricas* obtenerInstancia() {
+        RegistroMetricas* actual = instancia.load(std::memory_order_acquire);
+        if (actual == nullptr) {
+            std::lock_guard<std::mutex> lock(mutexInstancia);
+            actual = instancia.load(std::memory_order_relaxed);
+            if (actual == nullptr) {
+                actual = new RegistroMetricas();
+                const char* puerto = std::getenv("METRICAS_PUERTO");
+                const char* archivo = std::getenv("METRICAS_ARCHIVO");
+                const char* intervalo = std::getenv("METRICAS_INTERVALO_MS");
+                if (puerto != nullptr || archivo != nullptr) {
+                    actual->iniciarExportacion(puerto != nullptr ? std::atoi(puerto) : 0,
+                                               archivo != nullptr ? archivo : "",
+                                               intervalo != nullptr ? std::atoi(intervalo) : 1000);
+                }
+                instancia.store(actual, std::memory_order_release);
+            }
+        }
+        return actual;
+    }
+
+    uint32_t registrarContador(const std::string& nombre, const std::string& ayuda) {
+        return registrar(nombre, ayuda, METRICA_CONTADOR);
+    }
+    uint32_t registrarMedidor(const std::string& nombre, const std::string& ayuda) {
+        return registrar(nombre, ayuda, METRICA_MEDIDOR);
+    }
+    uint32_t registrarHistograma(const std::string& nombre, const std::string& ayuda) {
+        return registrar(nombre, ayuda, METRICA_HISTOGRAMA);
+    }
+
+    void incrementar(uint32_t id, uint64_t n) {
+        if (id >= MAX_CONTADORES) return;
+        sumarLocal(fragmentoDelHilo()->contadores[id], n);
+    }
+
+    void fijarMedidor(uint32_t id, int64_t valor) {
+        if (id < MAX_MEDIDORES) medidores[id].store(valor, std::memory_order_relaxed);
+    }
+
+    void sumarMedidor(uint32_t id, int64_t delta) {
+        if (id < MAX_MEDIDORES) medidores[id].fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    void observar(uint32_t id, uint64_t valor) {
+        if (id >= MAX_HISTOGRAMAS) return;
+        Fragmento* f = fragmentoDelHilo();
+        HistogramaLocal* h = f->histogramas[id].load(std::memory_order_relaxed);
+        if (h == nullptr) {
+            // Primera observación de este hilo; la lista de propios solo la toca él
+            f->propios.push_back(std::unique_ptr<HistogramaLocal>(new HistogramaLocal()));
+            h = f->propios.back().get();
+            f->histogramas[id].store(h, std::memory_order_release);
+        }
+        sumarLocal(h->cubetas[EscalaHistograma::cubeta(valor)], 1);
+        sumarLocal(h->suma, valor);
+        sumarLocal(h->cantidad, 1);
+    }
+
+    // Formato de texto de Prometheus 0.0.4. Los histogramas (en ns) se
+    // exponen en segundos con cubetas 1-2-5 de 1 µs a 10 s, más una familia
+    // <nombre>_cuantiles con p50/p90/p99/p99.9.
+    std::string exportarTexto() {
+        static const double LIMITES[] = {1e-6, 2e-6, 5e-6, 1e-5, 2e-5, 5e-5, 1e-4, 2e-4, 5e-4,
+                                         1e-3, 2e-3, 5e-3, 1e-2, 2e-2, 5e-2, 0.1, 0.2, 0.5, 1, 2, 5, 10};
+        static const double CUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+        std::vector<Definicion> copia;
+        {
+            std::lock_guard<std::mutex> lock(mutexDefiniciones);
+            copia = definiciones;
+        }
+        std::stable_sort(copia.begin(), copia.end(), [](const Definicion& a, const Definicion& b) {
+            std::string fa, fb, ea, eb;
+            separar(a.nombre, fa, ea);
+            separar(b.nombre, fb, eb);
+            return fa < fb;
+        });
+
+        std::lock_guard<std::mutex> lock(mutexFragmentos);
+        std::ostringstream texto;
+        texto << std::setprecision(9);
+        std::string familiaAnterior;
+        std::ostringstream cuantiles;
+        cuantiles << std::setprecision(9);
+        for (size_t i = 0; i < copia.size(); i++) {
+            const Definicion& d = copia[i];
+            std::string familia, etiquetas;
+            separar(d.nombre, familia, etiquetas);
+            if (familia != familiaAnterior) {
+                texto << cuantiles.str();
+                cuantiles.str("");
+                const char* tipo = d.tipo == METRICA_CONTADOR ? "counter"
+                                 : d.tipo == METRICA_MEDIDOR ? "gauge" : "histogram";
+                texto << "# HELP " << familia << " " << d.ayuda << "\n";
+                texto << "# TYPE " << familia << " " << tipo << "\n";
+                if (d.tipo == METRICA_HISTOGRAMA) {
+                    cuantiles << "# HELP " << familia << "_cuantiles " << d.ayuda << " (percentiles)\n";
+                    cuantiles << "# TYPE " << familia << "_cuantiles summary\n";
+                }
+                familiaAnterior = familia;
+            }
+            if (d.tipo == METRICA_CONTADOR) {
+                texto << d.nombre << " " << totalContador(d.id) << "\n";
+            } else if (d.tipo == METRICA_MEDIDOR) {
+                texto << d.nombre << " " << medidores[d.id].load(std::memory_order_relaxed) << "\n";
+            } else {
+                ResumenHistograma r = totalHistograma(d.id);
+                for (size_t l = 0; l < sizeof(LIMITES) / sizeof(LIMITES[0]); l++) {
+                    std::ostringstream le;
+                    le << "le=\"" << LIMITES[l] << "\"";
+                    texto << conEtiquetas(familia + "_bucket", etiquetas, le.str()) << " "
+                          << r.hasta(static_cast<uint64_t>(LIMITES[l] * 1e9)) << "\n";
+                }
+                texto << conEtiquetas(familia + "_bucket", etiquetas, "le=\"+Inf\"") << " " << r.cantidad << "\n";
+                texto << conEtiquetas(familia + "_sum", etiquetas) << " " << r.suma / 1e9 << "\n";
+                texto << conEtiquetas(familia + "_count", etiquetas) << " " << r.cantidad << "\n";
+                for (size_t q = 0; q < sizeof(CUANTILES) / sizeof(CUANTILES[0]); q++) {
+                    std::ostringstream etiqueta;
+                    etiqueta << "quantile=\"" << CUANTILES[q] << "\"";
+                    cuantiles << conEtiquetas(familia + "_cuantiles", etiquetas, etiqueta.str()) << " "
+                              << r.percentil(CUANTILES[q]) / 1e9 << "\n";
+                }
+                cuantiles << conEtiquetas(familia + "_cuantiles_sum", etiquetas) << " " << r.suma / 1e9 << "\n";
+                cuantiles << conEtiquetas(familia + "_cuantiles_count", etiquetas) << " " << r.cantidad << "\n";
+            }
+        }
+        texto << cuantiles.str();
+        return texto.str();
+    }
+
+    // Escribe a un temporal y lo renombra: un lector nunca ve un volcado a medias
+    bool volcar(const std::string& ruta) {
+        std::string temporal = ruta + ".tmp";
+        {
+            std::ofstream archivo(temporal, std::ios::trunc);
+            if (!archivo.is_open()) return false;
+            archivo << exportarTexto();
+            if (!archivo.good()) return false;
+        }
+        return std::rename(temporal.c_str(), ruta.c_str()) == 0;
+    }
+
+    // Una línea por métrica: valor, o cantidad y percentiles en µs
+    void imprimirResumen(std::ostream& salida = std::cout) {
+        std::vector<Definicion> copia;
+        {
+            std::lock_guard<std::mutex> lock(mutexDefiniciones);
+            copia = definiciones;
+        }
+        std::lock_guard<std::mutex> lock(mutexFragmentos);
+        for (size_t i = 0; i < copia.size(); i++) {
+            const Definicion& d = copia[i];
+            salida << "   " << std::left << std::setw(74) << d.nombre << " " << std::right;
+            if (d.tipo == METRICA_CONTADOR) {
+                salida << totalContador(d.id) << "\n";
+            } else if (d.tipo == METRICA_MEDIDOR) {
+                salida << medidores[d.id].load(std::memory_order_relaxed) << "\n";
+            } else {
+                ResumenHistograma r = totalHistograma(d.id);
+                salida << "n=" << r.cantidad << std::fixed << std::setprecision(1)
+                       << " p50=" << r.percentil(0.5) / 1000.0 << "µs"
+                       << " p99=" << r.percentil(0.99) / 1000.0 << "µs"
+                       << " p99.9=" << r.percentil(0.999) / 1000.0 << "µs\n";
+            }
+        }
+    }
+
+    // puerto 0 = sin HTTP; archivo vacío = sin volcado periódico
+    bool iniciarExportacion(int puerto, const std::string& archivo, int intervaloMs = 1000) {
+        if (exportando.load()) return false;
+        if (puerto > 0) {
+            socketEscucha = socket(AF_INET, SOCK_STREAM, 0);
+            int si = 1;
+            setsockopt(socketEscucha, SOL_SOCKET, SO_REUSEADDR, &si, sizeof(si));
+            struct sockaddr_in direccion;
+            std::memset(&direccion, 0, sizeof(direccion));
+            direccion.sin_family = AF_INET;
+            direccion.sin_port = htons(static_cast<uint16_t>(puerto));
+            direccion.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            if (socketEscucha < 0 ||
+                bind(socketEscucha, reinterpret_cast<struct sockaddr*>(&direccion), sizeof(direccion)) != 0 ||
+                listen(socketEscucha, 16) != 0) {
+                std::cout << "❌ Métricas: no se pudo escuchar en 127.0.0.1:" << puerto << "\n";
+                if (socketEscucha >= 0) close(socketEscucha);
+                socketEscucha = -1;
+            } else {
+                std::cout << "📈 Métricas en http://127.0.0.1:" << puerto << "/metrics\n";
+            }
+        }
+        archivoVolcado = archivo;
+        intervaloVolcado = std::chrono::milliseconds(intervaloMs > 0 ? intervaloMs : 1000);
+        if (socketEscucha < 0 && archivoVolcado.empty()) return false;
+        exportando.store(true, std::memory_order_release);
+        hiloExportacion = std::thread(&RegistroMetricas::bucleExportacion, this);
+        return true;
+    }
+
+    void detenerExportacion() {
+        if (!exportando.exchange(false)) return;
+        if (hiloExportacion.joinable()) hiloExportacion.join();
+        if (socketEscucha >= 0) close(socketEscucha);
+        socketEscucha = -1;
+        if (!archivoVolcado.empty()) volcar(archivoVolcado);
+    }
+
+    static void destruirInstancia() {
+        RegistroMetricas* actual;
+        {
+            std::lock_guard<std::mutex> lock(mutexInstancia);
+            actual = instancia.exchange(nullptr);
+        }
+        // Fuera del lock: el hilo de exportación retira su fragmento al terminar
+        if (actual != nullptr) actual->detenerExportacion();
+        delete actual;
+    }
+};
+
+std::atomic<RegistroMetricas*> RegistroMetricas::instancia(nullptr);
+std::mutex RegistroMetricas::mutexInstancia;
+std::atomic<uint64_t> RegistroMetricas::contadorInstancias(0);
+const uint32_t RegistroMetricas::MAX_CONTADORES;
+const uint32_t RegistroMetricas::MAX_HISTOGRAMAS;
+const uint32_t RegistroMetricas::MAX_MEDIDORES;
+const uint32_t RegistroMetricas::SIN_METRICA;
+const uint64_t EscalaHistograma::SUB;
+const size_t EscalaHistograma::NUM_CUBETAS;
+
+// Manejadores: se registran una vez (por nombre) y después solo escriben
+class Contador {
+private:
+    uint32_t id;
+public:
+    Contador(const std::string& nombre, const std::string& ayuda)
+        : id(RegistroMetricas::obtenerInstancia()->registrarContador(nombre, ayuda)) {}
+    void incrementar(uint64_t n = 1) const { RegistroMetricas::obtenerInstancia()->incrementar(id, n); }
+};
+
+class Medidor {
+private:
+    uint32_t id;
+public:
+    Medidor(const std::string& nombre, const std::string& ayuda)
+        : id(RegistroMetricas::obtenerInstancia()->registrarMedidor(nombre, ayuda)) {}
+    void fijar(int64_t valor) const { RegistroMetricas::obtenerInstancia()->fijarMedidor(id, valor); }
+    void sumar(int64_t delta) const { RegistroMetricas::obtenerInstancia()->sumarMedidor(id, delta); }
+};
+
+class Histograma {
+private:
+    uint32_t id;
+public:
+    Histograma(const std::string& nombre, const std::string& ayuda)
+        : id(RegistroMetricas::obtenerInstancia()->registrarHistograma(nombre, ayuda)) {}
+    void observar(uint64_t nanos) const { RegistroMetricas::obtenerInstancia()->observar(id, nanos); }
+};
+
+// Observa en un histograma la duración del ámbito
+class CronometroMetrica {
+private:
+    const Histograma& histograma;
+    std::chrono::steady_clock::time_point inicio;
+public:
+    explicit CronometroMetrica(const Histograma& h) : histograma(h), inicio(std::chrono::steady_clock::now()) {}
+    ~CronometroMetrica() {
+        histograma.observar(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - inicio).count()));
+    }
+    CronometroMetrica(const CronometroMetrica&) = delete;
+    CronometroMetrica& operator=(const CronometroMetrica&) = delete;
+};
+
+#endif
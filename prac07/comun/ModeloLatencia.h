@@ -0,0 +1,363 @@
+#ifndef MODELOLATENCIA_H
+#define MODELOLATENCIA_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::nanoseconds Duracion;
+
+// ---------------------------------------------------------------------------
+// Modelos de latencia: deciden cuánto "tarda" cada operación simulada.
+// ---------------------------------------------------------------------------
+class ModeloLatencia {
+public:
+    virtual ~ModeloLatencia() {}
+    virtual Duracion siguiente() = 0;
+    virtual std::string describir() const = 0;
+    
+    // Especificación textual (p. ej. en variables de entorno):
+    //   cero | fija:<ms> | normal:<media_ms>:<desv_ms>
+    //   lognormal:<mediana_ms>:<sigma> | traza:<archivo con un valor en ms por línea>
+    // Devuelve nullptr si la especificación no es válida.
+    static std::shared_ptr<ModeloLatencia> crear(const std::string& especificacion);
+};
+
+class LatenciaCero : public ModeloLatencia {
+public:
+    Duracion siguiente() { return Duracion::zero(); }
+    std::string describir() const { return "cero"; }
+};
+
+class LatenciaFija : public ModeloLatencia {
+private:
+    Duracion valor;
+public:
+    explicit LatenciaFija(Duracion d) : valor(d) {}
+    Duracion siguiente() { return valor; }
+    std::string describir() const {
+        return "fija:" + std::to_string(valor.count() / 1e6) + "ms";
+    }
+};
+
+class LatenciaNormal : public ModeloLatencia {
+private:
+    std::mutex mutexGenerador;
+    std::mt19937_64 generador;
+    std::normal_distribution<double> distribucion;
+    double mediaMs, desviacionMs;
+public:
+    LatenciaNormal(double media, double desviacion, uint64_t semilla = 42)
+        : generador(semilla), distribucion(media, desviacion),
+          mediaMs(media), desviacionMs(desviacion) {}
+    Duracion siguiente() {
+        double ms;
+        {
+            std::lock_guard<std::mutex> lock(mutexGenerador);
+            ms = distribucion(generador);
+        }
+        return Duracion(static_cast<int64_t>(std::max(0.0, ms) * 1e6));
+    }
+    std::string describir() const {
+        return "normal(" + std::to_string(mediaMs) + "ms, " + std::to_string(desviacionMs) + "ms)";
+    }
+};
+
+// Cola larga típica de un backend real: la mayoría de respuestas cerca de
+// la mediana y unas pocas muy lentas.
+class LatenciaLogNormal : public ModeloLatencia {
+private:
+    std::mutex mutexGenerador;
+    std::mt19937_64 generador;
+    std::lognormal_distribution<double> distribucion;
+    double medianaMs, sigma;
+public:
+    LatenciaLogNormal(double mediana, double s, uint64_t semilla = 42)
+        : generador(semilla), distribucion(std::log(mediana), s),
+          medianaMs(mediana), sigma(s) {}
+    Duracion siguiente() {
+        double ms;
+        {
+            std::lock_guard<std::mutex> lock(mutexGenerador);
+            ms = distribucion(generador);
+        }
+        return Duracion(static_cast<int64_t>(ms * 1e6));
+    }
+    std::string describir() const {
+        return "lognormal(mediana " + std::to_string(medianaMs) + "ms, sigma " + std::to_string(sigma) + ")";
+    }
+};
+
+// Reproduce latencias medidas en producción, en orden y de forma cíclica
+class LatenciaTraza : public ModeloLatencia {
+private:
+    std::vector<Duracion> muestras;
+    std::atomic<size_t> posicion;
+    std::string origen;
+public:
+    LatenciaTraza(const std::vector<Duracion>& valores, const std::string& ruta)
+        : muestras(valores), posicion(0), origen(ruta) {}
+    
+    static std::shared_ptr<ModeloLatencia> cargar(const std::string& ruta) {
+        std::ifstream archivo(ruta);
+        if (!archivo.is_open()) return nullptr;
+        std::vector<Duracion> valores;
+        double ms;
+        while (archivo >> ms) valores.push_back(Duracion(static_cast<int64_t>(ms * 1e6)));
+        if (valores.empty()) return nullptr;
+        return std::make_shared<LatenciaTraza>(valores, ruta);
+    }
+    
+    Duracion siguiente() {
+        return muestras[posicion.fetch_add(1, std::memory_order_relaxed) % muestras.size()];
+    }
+    std::string describir() const {
+        return "traza:" + origen + " (" + std::to_string(muestras.size()) + " muestras)";
+    }
+};
+
+inline std::shared_ptr<ModeloLatencia> ModeloLatencia::crear(const std::string& especificacion) {
+    std::vector<std::string> partes;
+    std::stringstream ss(especificacion);
+    std::string parte;
+    while (std::getline(ss, parte, ':')) partes.push_back(parte);
+    if (partes.empty()) return nullptr;
+    
+    const std::string& tipo = partes[0];
+    if (tipo == "cero" && partes.size() == 1) {
+        return std::make_shared<LatenciaCero>();
+    }
+    if (tipo == "traza" && partes.size() == 2) {
+        return LatenciaTraza::cargar(partes[1]);
+    }
+    
+    std::vector<double> valores;
+    for (size_t i = 1; i < partes.size(); i++) {
+        char* fin = nullptr;
+        double v = std::strtod(partes[i].c_str(), &fin);
+        if (fin == partes[i].c_str() || *fin != '\0' || v < 0) return nullptr;
+        valores.push_back(v);
+    }
+    if (tipo == "fija" && valores.size() == 1) {
+        return std::make_shared<LatenciaFija>(Duracion(static_cast<int64_t>(valores[0] * 1e6)));
+    }
+    if (tipo == "normal" && valores.size() == 2) {
+        return std::make_shared<LatenciaNormal>(valores[0], valores[1]);
+    }
+    if (tipo == "lognormal" && valores.size() == 2 && valores[0] > 0) {
+        return std::make_shared<LatenciaLogNormal>(valores[0], valores[1]);
+    }
+    return nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// Relojes: el real duerme; el virtual solo avanza un contador, de modo que
+// la misma ejecución mide el coste de CPU sin esperar la latencia simulada.
+// ---------------------------------------------------------------------------
+class Reloj {
+public:
+    virtual ~Reloj() {}
+    virtual void esperar(Duracion d) = 0;
+    virtual Duracion ahora() const = 0;
+};
+
+class RelojReal : public Reloj {
+public:
+    void esperar(Duracion d) {
+        if (d > Duracion::zero()) std::this_thread::sleep_for(d);
+    }
+    Duracion ahora() const {
+        return std::chrono::duration_cast<Duracion>(
+            std::chrono::steady_clock::now().time_since_epoch());
+    }
+};
+
+// Cada hilo lleva su propio instante virtual: esperas concurrentes de hilos
+// distintos se solapan en vez de sumarse, y el reloj global es el mayor
+// instante alcanzado por cualquier hilo. ahora() pone al hilo al día con el
+// global; una espera empieza en el instante del hilo o en el último que
+// alguien observó con ahora(), el mayor de los dos (así un lote de trabajo
+// lanzado después de mirar el reloj no empieza en el pasado).
+class RelojVirtual : public Reloj {
+private:
+    static std::atomic<uint64_t> contadorRelojes;
+
+    uint64_t idReloj;
+    std::atomic<int64_t> maximo;       // mayor instante alcanzado por un hilo
+    mutable std::atomic<int64_t> observado;    // mayor instante devuelto por ahora()
+
+    struct InstanteHilo {
+        uint64_t reloj;
+        int64_t nanosegundos;
+    };
+
+    InstanteHilo& instanteDelHilo() const {
+        // El id invalida el instante cacheado si el hilo cambia de reloj
+        static thread_local InstanteHilo instante = {0, 0};
+        if (instante.reloj != idReloj) {
+            instante.reloj = idReloj;
+            instante.nanosegundos = 0;
+        }
+        return instante;
+    }
+
+    static void subirA(std::atomic<int64_t>& valor, int64_t nuevo) {
+        int64_t actual = valor.load(std::memory_order_relaxed);
+        while (actual < nuevo && !valor.compare_exchange_weak(actual, nuevo, std::memory_order_relaxed)) {}
+    }
+
+public:
+    RelojVirtual() : idReloj(contadorRelojes.fetch_add(1) + 1), maximo(0), observado(0) {}
+
+    void esperar(Duracion d) {
+        InstanteHilo& hilo = instanteDelHilo();
+        int64_t inicio = std::max(hilo.nanosegundos, observado.load(std::memory_order_relaxed));
+        hilo.nanosegundos = inicio + (d > Duracion::zero() ? d.count() : 0);
+        subirA(maximo, hilo.nanosegundos);
+    }
+
+    Duracion ahora() const {
+        InstanteHilo& hilo = instanteDelHilo();
+        hilo.nanosegundos = std::max(hilo.nanosegundos, maximo.load(std::memory_order_relaxed));
+        subirA(observado, hilo.nanosegundos);
+        return Duracion(hilo.nanosegundos);
+    }
+};
+
+std::atomic<uint64_t> RelojVirtual::contadorRelojes(0);
+
+// ---------------------------------------------------------------------------
+// Entorno global de latencia (Singleton thread-safe). Lee la configuración
+// de variables de entorno para poder cambiar de modelo sin recompilar:
+//   LATENCIA_<OPERACION>  modelo de una operación (CONECTAR, CONSULTA, ...)
+//   LATENCIA_BD           modelo para todas las operaciones de BD
+//   LATENCIA_PAUSAS       "cero" elimina las pausas de las demos
+//   LATENCIA_RELOJ        "virtual" para no dormir nunca
+// ---------------------------------------------------------------------------
+class EntornoLatencia {
+private:
+    static std::atomic<EntornoLatencia*> instancia;
+    static std::mutex mutexInstancia;
+    
+    RelojReal relojReal;
+    RelojVirtual relojVirtual;
+    std::atomic<Reloj*> relojActivo;
+    std::atomic<bool> pausasActivas;
+    
+    EntornoLatencia() : relojActivo(&relojReal), pausasActivas(true) {
+        const char* reloj = std::getenv("LATENCIA_RELOJ");
+        if (reloj != nullptr && std::string(reloj) == "virtual") relojActivo = &relojVirtual;
+        const char* pausas = std::getenv("LATENCIA_PAUSAS");
+        if (pausas != nullptr && std::string(pausas) == "cero") pausasActivas = false;
+    }
+    
+    EntornoLatencia(const EntornoLatencia&) = delete;
+    EntornoLatencia& operator=(const EntornoLatencia&) = delete;
+
+public:
+    static EntornoLatencia* obtenerInstancia() {
+        EntornoLatencia* actual = instancia.load(std::memory_order_acquire);
+        if (actual == nullptr) {
+            std::lock_guard<std::mutex> lock(mutexInstancia);
+            actual = instancia.load(std::memory_order_relaxed);
+            if (actual == nullptr) {
+                actual = new EntornoLatencia();
+                instancia.store(actual, std::memory_order_release);
+            }
+        }
+        return actual;
+    }
+    
+    // Modelo para una operación: variable específica, luego LATENCIA_BD,
+    // y si ninguna está definida (o es inválida), el valor por defecto.
+    std::shared_ptr<ModeloLatencia> modeloPara(const std::string& operacion,
+                                               const std::string& porDefecto) {
+        const char* candidatos[2] = {
+            std::getenv(("LATENCIA_" + operacion).c_str()),
+            std::getenv("LATENCIA_BD")
+        };
+        for (int i = 0; i < 2; i++) {
+            if (candidatos[i] == nullptr) continue;
+            std::shared_ptr<ModeloLatencia> m = ModeloLatencia::crear(candidatos[i]);
+            if (m) return m;
+            std::cerr << "⚠️  Modelo de latencia inválido '" << candidatos[i]
+                      << "' para " << operacion << ", se usa '" << porDefecto << "'\n";
+        }
+        return ModeloLatencia::crear(porDefecto);
+    }
+    
+    Reloj& getReloj() { return *relojActivo.load(std::memory_order_acquire); }
+    void usarRelojVirtual() { relojActivo = &relojVirtual; }
+    void usarRelojReal() { relojActivo = &relojReal; }
+    bool usaRelojVirtual() const { return relojActivo.load() == &relojVirtual; }
+    
+    void setPausasActivas(bool valor) { pausasActivas = valor; }
+    
+    // Pausas de las demos (escalonar hilos, simular trabajo del cliente)
+    void pausa(Duracion d) {
+        if (pausasActivas.load(std::memory_order_relaxed)) getReloj().esperar(d);
+    }
+    
+    static void destruirInstancia() {
+        std::lock_guard<std::mutex> lock(mutexInstancia);
+        EntornoLatencia* actual = instancia.exchange(nullptr);
+        delete actual;
+    }
+};
+
+std::atomic<EntornoLatencia*> EntornoLatencia::instancia(nullptr);
+std::mutex EntornoLatencia::mutexInstancia;
+
+// Latencia de una operación concreta: un modelo intercambiable en tiempo de
+// ejecución más el reloj activo del entorno.
+class InyectorLatencia {
+private:
+    std::shared_ptr<ModeloLatencia> modelo;   // acceso con std::atomic_load/store
+
+public:
+    InyectorLatencia(const std::string& operacion, const std::string& porDefecto)
+        : modelo(EntornoLatencia::obtenerInstancia()->modeloPara(operacion, porDefecto)) {}
+    
+    // La copia comparte el modelo vigente; leerlo con atomic_load evita la
+    // carrera con un setModelo() concurrente sobre el original
+    InyectorLatencia(const InyectorLatencia& otro) : modelo(otro.getModelo()) {}
+    
+    InyectorLatencia& operator=(const InyectorLatencia& otro) {
+        setModelo(otro.getModelo());
+        return *this;
+    }
+    
+    void setModelo(std::shared_ptr<ModeloLatencia> nuevo) {
+        std::atomic_store(&modelo, nuevo);
+    }
+    
+    std::shared_ptr<ModeloLatencia> getModelo() const {
+        return std::atomic_load(&modelo);
+    }
+    
+    // Solo decide la latencia, sin esperar (para planificadores que la
+    // esperan por su cuenta, p. ej. comun/Corrutinas.h)
+    Duracion muestrear() {
+        return getModelo()->siguiente();
+    }
+    
+    // Espera la latencia simulada y devuelve cuánto fue
+    Duracion aplicar() {
+        Duracion d = getModelo()->siguiente();
+        EntornoLatencia::obtenerInstancia()->getReloj().esperar(d);
+        return d;
+    }
+};
+
+#endif
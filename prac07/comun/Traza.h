@@ -0,0 +1,320 @@
+#ifndef TRAZA_H
+#define TRAZA_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Evento completo ("ph":"X" en el formato de trazas de Chrome)
+struct EventoTraza {
+    const char* nombre;      // cadenas estáticas: no se copian al registrar
+    const char* categoria;
+    uint64_t inicioNs;
+    uint64_t duracionNs;
+};
+
+// Buffer de un hilo. Solo su hilo escribe; la exportación lee hasta
+// 'cantidad' (publicada con release), por lo que no hace falta lock.
+class BufferTraza {
+private:
+    std::unique_ptr<EventoTraza[]> eventos;
+    size_t capacidad;
+    std::atomic<size_t> cantidad;
+    std::atomic<uint64_t> descartados;
+    uint32_t idHilo;
+
+public:
+    BufferTraza(size_t cap, uint32_t id)
+        : eventos(new EventoTraza[cap]), capacidad(cap), cantidad(0), descartados(0), idHilo(id) {}
+    
+    void registrar(const char* nombre, const char* categoria, uint64_t inicio, uint64_t duracion) {
+        size_t n = cantidad.load(std::memory_order_relaxed);
+        if (n >= capacidad) {
+            descartados.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        EventoTraza& e = eventos[n];
+        e.nombre = nombre;
+        e.categoria = categoria;
+        e.inicioNs = inicio;
+        e.duracionNs = duracion;
+        cantidad.store(n + 1, std::memory_order_release);
+    }
+    
+    size_t getCantidad() const { return cantidad.load(std::memory_order_acquire); }
+    const EventoTraza& getEvento(size_t i) const { return eventos[i]; }
+    uint64_t getDescartados() const { return descartados.load(std::memory_order_relaxed); }
+    uint32_t getIdHilo() const { return idHilo; }
+    void vaciar() { cantidad.store(0, std::memory_order_release); }
+};
+
+// Eventos de un hilo que ya terminó: solo los registrados, sin la capacidad
+// sobrante de su BufferTraza
+struct EventosRetirados {
+    uint32_t idHilo;
+    uint64_t descartados;
+    std::vector<EventoTraza> eventos;
+};
+
+// Singleton de trazado. Desactivado, un span cuesta una carga atómica
+// relajada; compilando con -DTRAZA_DESACTIVADA los spans desaparecen.
+// Con la variable de entorno TRAZA=<archivo.json> se activa al arrancar y
+// la traza se exporta en destruirInstancia().
+//
+// Al terminar un hilo, sus eventos se copian a un vector de su tamaño y su
+// buffer (1 << 16 eventos) se libera. destruirInstancia() despublica la
+// instancia y espera a que acaben los spans que ya estaban registrando
+// antes de exportar y liberar los buffers.
+class Rastreador {
+private:
+    static std::atomic<Rastreador*> instancia;
+    static std::mutex mutexInstancia;
+    static std::atomic<bool> habilitado;
+    static std::atomic<uint64_t> contadorInstancias;
+    static std::atomic<int> registrosEnCurso;
+    
+    uint64_t idInstancia;
+    std::mutex mutexBuffers;
+    std::vector<std::unique_ptr<BufferTraza> > buffers;
+    std::vector<EventosRetirados> retirados;
+    uint32_t siguienteIdHilo;
+    std::chrono::steady_clock::time_point origen;
+    std::string archivoSalida;
+    size_t capacidadPorHilo;
+    
+    Rastreador() : idInstancia(contadorInstancias.fetch_add(1) + 1), siguienteIdHilo(1),
+                   origen(std::chrono::steady_clock::now()), capacidadPorHilo(1 << 16) {
+        const char* destino = std::getenv("TRAZA");
+        if (destino != nullptr && *destino != '\0') {
+            archivoSalida = destino;
+            habilitado.store(true, std::memory_order_relaxed);
+        }
+    }
+    
+    Rastreador(const Rastreador&) = delete;
+    Rastreador& operator=(const Rastreador&) = delete;
+    
+    // Inicializa 'habilitado' antes de main para que los spans registren
+    // desde la primera llamada sin tener que crear antes la instancia
+    static bool habilitadoPorEntorno() {
+        const char* destino = std::getenv("TRAZA");
+        return destino != nullptr && *destino != '\0';
+    }
+    
+    // Buffer cacheado por el hilo; al terminar el hilo lo retira
+    struct BufferHilo {
+        BufferTraza* buffer;
+        uint64_t propietario;
+        BufferHilo() : buffer(nullptr), propietario(0) {}
+        ~BufferHilo() {
+            if (buffer != nullptr) retirarBuffer(propietario, buffer);
+        }
+    };
+    
+    BufferTraza* bufferDelHilo() {
+        // El id de instancia invalida el buffer cacheado si el rastreador se recrea
+        // (el anterior ya se liberó con su rastreador)
+        static thread_local BufferHilo hilo;
+        if (hilo.propietario != idInstancia) {
+            std::lock_guard<std::mutex> lock(mutexBuffers);
+            buffers.push_back(std::unique_ptr<BufferTraza>(new BufferTraza(capacidadPorHilo, siguienteIdHilo++)));
+            hilo.buffer = buffers.back().get();
+            hilo.propietario = idInstancia;
+        }
+        return hilo.buffer;
+    }
+    
+    // Copia los eventos a `retirados` y libera el buffer. mutexInstancia
+    // impide que el rastreador se destruya a la vez; si ya no es el del
+    // buffer, este murió con su rastreador.
+    static void retirarBuffer(uint64_t propietario, BufferTraza* buffer) {
+        std::lock_guard<std::mutex> lockInstancia(mutexInstancia);
+        Rastreador* actual = instancia.load(std::memory_order_acquire);
+        if (actual == nullptr || actual->idInstancia != propietario) return;
+        std::lock_guard<std::mutex> lock(actual->mutexBuffers);
+        size_t n = buffer->getCantidad();
+        if (n > 0 || buffer->getDescartados() > 0) {
+            EventosRetirados r;
+            r.idHilo = buffer->getIdHilo();
+            r.descartados = buffer->getDescartados();
+            r.eventos.reserve(n);
+            for (size_t i = 0; i < n; i++) r.eventos.push_back(buffer->getEvento(i));
+            actual->retirados.push_back(std::move(r));
+        }
+        for (size_t b = 0; b < actual->buffers.size(); b++) {
+            if (actual->buffers[b].get() == buffer) {
+                actual->buffers[b].swap(actual->buffers.back());
+                actual->buffers.pop_back();
+                break;
+            }
+        }
+    }
+    
+    static void escribirEvento(std::ofstream& archivo, const EventoTraza& e, uint32_t idHilo, bool& primero) {
+        char linea[512];
+        snprintf(linea, sizeof(linea),
+                 "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                 primero ? "" : ",\n", e.nombre, e.categoria,
+                 e.inicioNs / 1000.0, e.duracionNs / 1000.0, idHilo);
+        archivo << linea;
+        primero = false;
+    }
+
+public:
+    static Rastreador* obtenerInstancia() {
+        Rastreador* actual = instancia.load(std::memory_order_acquire);
+        if (actual == nullptr) {
+            std::lock_guard<std::mutex> lock(mutexInstancia);
+            actual = instancia.load(std::memory_order_relaxed);
+            if (actual == nullptr) {
+                actual = new Rastreador();
+                instancia.store(actual, std::memory_order_release);
+            }
+        }
+        return actual;
+    }
+    
+    static bool activo() { return habilitado.load(std::memory_order_relaxed); }
+    
+    void activar(const std::string& archivo = "") {
+        if (!archivo.empty()) archivoSalida = archivo;
+        habilitado.store(true, std::memory_order_relaxed);
+    }
+    
+    void desactivar() { habilitado.store(false, std::memory_order_relaxed); }
+    
+    uint64_t ahoraNs() const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - origen).count());
+    }
+    
+    void registrar(const char* nombre, const char* categoria, uint64_t inicio, uint64_t duracion) {
+        bufferDelHilo()->registrar(nombre, categoria, inicio, duracion);
+    }
+    
+    // Cierra un span si el rastreador sigue publicado (no lo recrea).
+    // destruirInstancia() espera a que registrosEnCurso vuelva a cero.
+    static void registrarSpan(const char* nombre, const char* categoria, uint64_t inicio) {
+        registrosEnCurso.fetch_add(1);
+        Rastreador* actual = instancia.load();
+        if (actual != nullptr) {
+            uint64_t fin = actual->ahoraNs();
+            actual->registrar(nombre, categoria, inicio, fin > inicio ? fin - inicio : 0);
+        }
+        registrosEnCurso.fetch_sub(1, std::memory_order_release);
+    }
+    
+    // Exporta en formato Chrome trace-event (chrome://tracing, Perfetto)
+    bool exportarChrome(const std::string& ruta) {
+        std::ofstream archivo(ruta, std::ios::trunc);
+        if (!archivo.is_open()) return false;
+        
+        std::lock_guard<std::mutex> lock(mutexBuffers);
+        archivo << "{\"traceEvents\":[\n";
+        bool primero = true;
+        uint64_t descartados = 0;
+        for (size_t r = 0; r < retirados.size(); r++) {
+            descartados += retirados[r].descartados;
+            for (size_t i = 0; i < retirados[r].eventos.size(); i++) {
+                escribirEvento(archivo, retirados[r].eventos[i], retirados[r].idHilo, primero);
+            }
+        }
+        for (size_t b = 0; b < buffers.size(); b++) {
+            const BufferTraza& buf = *buffers[b];
+            descartados += buf.getDescartados();
+            size_t n = buf.getCantidad();
+            for (size_t i = 0; i < n; i++) escribirEvento(archivo, buf.getEvento(i), buf.getIdHilo(), primero);
+        }
+        archivo << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"eventosDescartados\":"
+                << descartados << "}}\n";
+        return archivo.good();
+    }
+    
+    size_t totalEventos() {
+        std::lock_guard<std::mutex> lock(mutexBuffers);
+        size_t total = 0;
+        for (size_t r = 0; r < retirados.size(); r++) total += retirados[r].eventos.size();
+        for (size_t b = 0; b < buffers.size(); b++) total += buffers[b]->getCantidad();
+        return total;
+    }
+    
+    static void destruirInstancia() {
+        Rastreador* actual;
+        {
+            std::lock_guard<std::mutex> lock(mutexInstancia);
+            habilitado.store(false, std::memory_order_relaxed);
+            actual = instancia.exchange(nullptr);
+        }
+        if (actual == nullptr) return;
+        // Un span que leyó la instancia antes del exchange ya contó en
+        // registrosEnCurso (ambos seq_cst): se espera a que termine
+        while (registrosEnCurso.load(std::memory_order_acquire) != 0) std::this_thread::yield();
+        if (!actual->archivoSalida.empty()) actual->exportarChrome(actual->archivoSalida);
+        delete actual;
+    }
+};
+
+std::atomic<Rastreador*> Rastreador::instancia(nullptr);
+std::mutex Rastreador::mutexInstancia;
+std::atomic<bool> Rastreador::habilitado(Rastreador::habilitadoPorEntorno());
+std::atomic<uint64_t> Rastreador::contadorInstancias(0);
+std::atomic<int> Rastreador::registrosEnCurso(0);
+
+// Span RAII: mide desde su construcción hasta el final del ámbito
+class SpanTraza {
+private:
+    const char* nombre;
+    const char* categoria;
+    uint64_t inicio;
+    bool activo;
+
+public:
+    SpanTraza(const char* n, const char* c) : nombre(n), categoria(c), inicio(0),
+                                              activo(Rastreador::activo()) {
+        if (activo) inicio = Rastreador::obtenerInstancia()->ahoraNs();
+    }
+    
+    ~SpanTraza() {
+        if (activo) Rastreador::registrarSpan(nombre, categoria, inicio);
+    }
+    
+    SpanTraza(const SpanTraza&) = delete;
+    SpanTraza& operator=(const SpanTraza&) = delete;
+};
+
+// Adquiere un mutex registrando la espera como span de categoría "lock".
+// Se usa como std::lock_guard; solo la adquisición queda dentro del span.
+template <typename Mutex>
+class LockTrazado {
+private:
+    Mutex& mutex;
+
+public:
+    LockTrazado(Mutex& m, const char* nombre) : mutex(m) {
+        SpanTraza espera(nombre, "lock");
+        mutex.lock();
+    }
+    ~LockTrazado() { mutex.unlock(); }
+    
+    LockTrazado(const LockTrazado&) = delete;
+    LockTrazado& operator=(const LockTrazado&) = delete;
+};
+
+#define TRAZA_CONCAT_(a, b) a##b
+#define TRAZA_CONCAT(a, b) TRAZA_CONCAT_(a, b)
+
+#ifdef TRAZA_DESACTIVADA
+#define TRAZA_SPAN(nombre, categoria) ((void)0)
+#else
+#define TRAZA_SPAN(nombre, categoria) SpanTraza TRAZA_CONCAT(spanTraza_, __LINE__)(nombre, categoria)
+#endif
+
+#endif
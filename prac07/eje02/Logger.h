@@ -7,13 +7,26 @@
 #include <ctime>
 #include <sstream>
 #include <iomanip>
+#include "../comun/Traza.h"
+#include "../comun/LimitadorLog.h"
+#include "../comun/Metricas.h"
 
 class Logger {
 private:
     static Logger* instancia;
     std::string archivoLog;
+    LimitadorLog limitador;
+    Contador metricaEscritas;
+    Contador metricaSuprimidas;
+    Histograma metricaEscritura;
     
-    Logger() : archivoLog("bitacora.log") {
+    Logger() : archivoLog("bitacora.log"),
+               metricaEscritas("prac07_log_lineas_total{logger=\"Logger\",resultado=\"escrita\"}",
+                               "Líneas de log escritas o descartadas por el límite de frecuencia"),
+               metricaSuprimidas("prac07_log_lineas_total{logger=\"Logger\",resultado=\"suprimida\"}",
+                                 "Líneas de log escritas o descartadas por el límite de frecuencia"),
+               metricaEscritura("prac07_log_escritura_segundos{logger=\"Logger\"}",
+                                "Duración de formatear y escribir una línea admitida") {
         std::ofstream archivo(archivoLog, std::ios::app);
         if (archivo.is_open()) {
             archivo << "\n" << std::string(80, '=') << "\n";
@@ -23,6 +36,17 @@ private:
         }
     }
     
+    // Deja constancia de las repeticiones que no llegaron a resumirse
+    ~Logger() {
+        unsigned long pendientes = limitador.pendientes();
+        if (pendientes == 0) return;
+        std::ofstream archivo(archivoLog, std::ios::app);
+        if (archivo.is_open()) {
+            archivo << "[" << obtenerTimestamp() << "] [INFO] " << pendientes
+                    << " mensajes repetidos suprimidos sin resumir\n";
+        }
+    }
+    
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
     
@@ -43,10 +67,19 @@ public:
         return instancia;
     }
     
-    void log(const std::string& mensaje, const std::string& nivel = "INFO") {
+    void log(const std::string& mensaje, const std::string& nivel = "INFO", SitioLog sitio = SitioLog()) {
+        unsigned long repetidas;
+        if (!limitador.admitir(LimitadorLog::clave(sitio, nivel, mensaje), repetidas)) {
+            metricaSuprimidas.incrementar();
+            return;
+        }
+        TRAZA_SPAN("Logger::log", "log");
+        CronometroMetrica cronometro(metricaEscritura);
+        metricaEscritas.incrementar();
         std::string timestamp = obtenerTimestamp();
         std::stringstream lineaLog;
         lineaLog << "[" << timestamp << "] [" << nivel << "] " << mensaje;
+        if (repetidas > 0) lineaLog << " [mensaje repetido " << repetidas << " veces]";
         
         std::ofstream archivo(archivoLog, std::ios::app);
         if (archivo.is_open()) {
@@ -57,22 +90,30 @@ public:
         std::cout << lineaLog.str() << "\n";
     }
     
-    void info(const std::string& mensaje) {
-        log(mensaje, "INFO");
+    void info(const std::string& mensaje, SitioLog sitio = SitioLog()) {
+        log(mensaje, "INFO", sitio);
+    }
+    
+    void warning(const std::string& mensaje, SitioLog sitio = SitioLog()) {
+        log(mensaje, "WARNING", sitio);
     }
     
-    void warning(const std::string& mensaje) {
-        log(mensaje, "WARNING");
+    void error(const std::string& mensaje, SitioLog sitio = SitioLog()) {
+        log(mensaje, "ERROR", sitio);
     }
     
-    void error(const std::string& mensaje) {
-        log(mensaje, "ERROR");
+    void debug(const std::string& mensaje, SitioLog sitio = SitioLog()) {
+        log(mensaje, "DEBUG", sitio);
     }
     
-    void debug(const std::string& mensaje) {
-        log(mensaje, "DEBUG");
+    // Ráfaga y líneas por segundo por sitio de llamada; rafaga = 0 lo desactiva
+    void setLimiteFrecuencia(double rafaga, double porSegundo) {
+        limitador.configurar(rafaga, porSegundo);
     }
     
+    unsigned long getLineasEscritas() const { return limitador.getAdmitidas(); }
+    unsigned long getLineasSuprimidas() const { return limitador.getSuprimidas(); }
+    
     static void destruirInstancia() {
         if (instancia != nullptr) {
             delete instancia;
@@ -1,5 +1,27 @@
 #include "Logger.h"
 #include <iostream>
+#include <chrono>
+#include <thread>
+
+// Cuatro sitios calientes agotan las vías de un conjunto del limitador: la
+// primera línea de un quinto sitio del mismo conjunto tiene que entrar, y
+// las repeticiones de un sitio expulsado se resumen cuando vuelve
+bool verificarSitioNuevo() {
+    LimitadorLog limitador;
+    limitador.configurar(20, 5);
+    unsigned long repetidas;
+    for (uint64_t k = 1; k <= 4; k++) {
+        for (int i = 0; i < 25; i++) limitador.admitir(k * 64, repetidas);
+    }
+    bool primeraAdmitida = limitador.admitir(5 * 64, repetidas);
+    // El sitio 1 (el expulsado) vuelve con una ficha recargada y sus 5
+    // repeticiones pendientes
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    bool resumida = limitador.admitir(64, repetidas) && repetidas == 5;
+    std::cout << (primeraAdmitida ? "✅" : "❌") << " Primera línea de un sitio nuevo con el conjunto lleno\n";
+    std::cout << (resumida ? "✅" : "❌") << " Un sitio expulsado resume sus repeticiones al volver\n";
+    return primeraAdmitida && resumida;
+}
 
 // Simulación de módulos del sistema
 class ModuloUsuarios {
@@ -44,8 +66,8 @@ public:
     }
     
     void consultar(const std::string& query) {
-        logger->debug("ModuloBaseDatos: Ejecutando query: " + query);
-        logger->error("ModuloBaseDatos: Error de sintaxis en la query");
+        logger->debug("ModuloBaseDatos: Ejecutando query: " + query, LOG_SITIO);
+        logger->error("ModuloBaseDatos: Error de sintaxis en la query", LOG_SITIO);
     }
 };
 
@@ -89,6 +111,32 @@ int main() {
     loggerDirecto->warning("Esta es una advertencia importante");
     loggerDirecto->error("Se ha detectado un error crítico");
     
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "TORMENTA DE ERRORES: LÍMITE POR SITIO DE LLAMADA\n";
+    std::cout << std::string(80, '=') << "\n\n";
+    
+    const int consultasFallidas = 10000;
+    unsigned long escritasAntes = loggerDirecto->getLineasEscritas();
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < consultasFallidas; i++) {
+        moduloBD.consultar("SELECT * FROM usuarios WHERE id = " + std::to_string(i));
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+    
+    std::cout << "\n🌩️  " << consultasFallidas << " consultas fallidas en " << ms << " ms\n";
+    std::cout << "   Líneas escritas: " << loggerDirecto->getLineasEscritas() - escritasAntes
+              << ", suprimidas: " << loggerDirecto->getLineasSuprimidas() << "\n";
+    
+    // Tras recargarse el cubo, la siguiente línea de cada sitio resume lo suprimido
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    std::cout << "\n";
+    moduloBD.consultar("SELECT * FROM usuarios WHERE id = 1");
+    
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "VERIFICACIÓN: Sitios nuevos con el conjunto del limitador lleno\n";
+    std::cout << std::string(80, '=') << "\n";
+    bool limitadorCorrecto = verificarSitioNuevo();
+    
     std::cout << "\n" << std::string(80, '=') << "\n";
     std::cout << "VERIFICACIÓN: Todos los módulos usan el mismo archivo de log\n";
     std::cout << std::string(80, '=') << "\n";
@@ -96,5 +144,7 @@ int main() {
     std::cout << "Verifica el contenido del archivo para confirmar.\n";
     
     Logger::destruirInstancia();
-    return 0;
+    Rastreador::destruirInstancia();
+    RegistroMetricas::destruirInstancia();
+    return limitadorCorrecto ? 0 : 1;
 }
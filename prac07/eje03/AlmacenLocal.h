@@ -0,0 +1,63 @@
+#ifndef ALMACENLOCAL_H
+#define ALMACENLOCAL_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Tablas en memoria para las escrituras de ConexionBD. Solo entiende
+// "INSERT INTO <tabla> VALUES (<valores>)": cada INSERT añade una fila con
+// el texto entre paréntesis. La durabilidad la da DiarioEscrituras; esto es
+// el estado que se reconstruye al reproducir el diario.
+class AlmacenLocal {
+private:
+    mutable std::mutex mutex;
+    std::map<std::string, std::vector<std::string> > tablas;
+
+public:
+    static bool esEscritura(const std::string& sql) {
+        return sql.compare(0, 12, "INSERT INTO ") == 0;
+    }
+
+    // Separa tabla y valores; false si la sentencia no tiene esa forma
+    static bool analizar(const std::string& sql, std::string& tabla, std::string& valores) {
+        if (!esEscritura(sql)) return false;
+        size_t finTabla = sql.find(' ', 12);
+        size_t abre = sql.find("VALUES (", 12);
+        size_t cierra = sql.rfind(')');
+        if (finTabla == std::string::npos || abre == std::string::npos ||
+            cierra == std::string::npos || cierra < abre + 8) return false;
+        tabla = sql.substr(12, finTabla - 12);
+        valores = sql.substr(abre + 8, cierra - abre - 8);
+        return true;
+    }
+
+    bool aplicar(const std::string& sql) {
+        std::string tabla, valores;
+        if (!analizar(sql, tabla, valores)) return false;
+        std::lock_guard<std::mutex> lock(mutex);
+        tablas[tabla].push_back(valores);
+        return true;
+    }
+
+    size_t contarFilas(const std::string& tabla) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::map<std::string, std::vector<std::string> >::const_iterator it = tablas.find(tabla);
+        return it == tablas.end() ? 0 : it->second.size();
+    }
+
+    // Copia de las filas (el almacén puede seguir recibiendo escrituras)
+    std::vector<std::string> filas(const std::string& tabla) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::map<std::string, std::vector<std::string> >::const_iterator it = tablas.find(tabla);
+        return it == tablas.end() ? std::vector<std::string>() : it->second;
+    }
+
+    void vaciar() {
+        std::lock_guard<std::mutex> lock(mutex);
+        tablas.clear();
+    }
+};
+
+#endif
@@ -1,10 +1,21 @@
 #ifndef CONEXIONBD_H
 #define CONEXIONBD_H
 
+#include <atomic>
+#include <future>
 #include <string>
 #include <iostream>
-#include <thread>
-#include <chrono>
+#include <memory>
+#include "../comun/ModeloLatencia.h"
+#include "../comun/Traza.h"
+#include "../comun/Corrutinas.h"
+#include "../comun/Metricas.h"
+#include "ResultadoConsulta.h"
+#include "TablaSimulada.h"
+#include "CursorConsulta.h"
+#include "ProteccionConsultas.h"
+#include "AlmacenLocal.h"
+#include "DiarioEscrituras.h"
 
 class ConexionBD {
 private:
@@ -14,14 +25,64 @@ private:
     int puerto;
     std::string baseDatos;
     std::string usuario;
-    int consultasEjecutadas;
+    std::atomic<int> consultasEjecutadas;
+    bool silencioso;
+    InyectorLatencia latenciaConectar;
+    InyectorLatencia latenciaDesconectar;
+    InyectorLatencia latenciaConsulta;
+    InyectorLatencia latenciaLote;
+    EstimadorLatencia estimador;
+    Cortacircuitos circuito;
+    FallosSimulados fallos;
+    Contador metricaConsultas;
+    Histograma metricaLatencia;
+    // Almacén local de las escrituras y su diario (ver abrirAlmacen)
+    AlmacenLocal almacen;
+    std::unique_ptr<DiarioEscrituras> diario;
+    size_t escriturasRecuperadas;
     
     ConexionBD() : conectado(false), host("localhost"), puerto(5432),
                    baseDatos("mi_aplicacion"), usuario("admin"), 
-                   consultasEjecutadas(0) {}
+                   consultasEjecutadas(0), silencioso(false),
+                   latenciaConectar("CONECTAR", "fija:1000"),
+                   latenciaDesconectar("DESCONECTAR", "fija:500"),
+                   latenciaConsulta("CONSULTA", "fija:300"),
+                   latenciaLote("LOTE", "fija:20"),
+                   metricaConsultas("prac07_bd_consultas_total{clase=\"ConexionBD\"}",
+                                    "Consultas completadas por la base de datos"),
+                   metricaLatencia("prac07_bd_consulta_segundos{clase=\"ConexionBD\"}",
+                                   "Duración de ejecutarConsulta, latencia del backend incluida"),
+                   escriturasRecuperadas(0) {}
+    
+    // El registro de conexiones crea instancias propias para sus pools
+    friend class PoolConexiones;
     
     ConexionBD(const ConexionBD&) = delete;
     ConexionBD& operator=(const ConexionBD&) = delete;
+    
+    // En modo silencioso los mensajes de cada consulta se descartan (demos
+    // con miles de peticiones concurrentes)
+    std::ostream& salida() const {
+        static thread_local std::ostream flujoNulo(nullptr);
+        return silencioso ? flujoNulo : std::cout;
+    }
+    
+    std::string completarConsulta() {
+        int numero = ++consultasEjecutadas;
+        metricaConsultas.incrementar();
+        salida() << "✅ Consulta ejecutada exitosamente (#" << numero << ")\n";
+        return "Resultado de la consulta #" + std::to_string(numero);
+    }
+    
+    // Añade la escritura al diario; se aplica al almacén cuando está en disco
+    std::future<uint64_t> anotar(const std::string& sql) {
+        std::string tabla, valores;
+        if (!AlmacenLocal::analizar(sql, tabla, valores)) {
+            std::cout << "❌ Error: escritura no soportada: " << sql << "\n";
+            return std::future<uint64_t>();
+        }
+        return diario->anadir(sql, [this, sql] { almacen.aplicar(sql); });
+    }
 
 public:
     static ConexionBD* obtenerInstancia() {
@@ -36,21 +97,25 @@ public:
     }
     
     bool conectar() {
+        TRAZA_SPAN("ConexionBD::conectar", "bd");
         if (conectado) {
             std::cout << "⚠️  Ya existe una conexión activa\n";
             return false;
         }
         
-        std::cout << "\n🔌 Intentando conectar a la base de datos...\n";
-        std::cout << "   Host: " << host << "\n";
-        std::cout << "   Puerto: " << puerto << "\n";
-        std::cout << "   Base de datos: " << baseDatos << "\n";
-        std::cout << "   Usuario: " << usuario << "\n";
+        salida() << "\n🔌 Intentando conectar a la base de datos...\n";
+        salida() << "   Host: " << host << "\n";
+        salida() << "   Puerto: " << puerto << "\n";
+        salida() << "   Base de datos: " << baseDatos << "\n";
+        salida() << "   Usuario: " << usuario << "\n";
         
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        {
+            TRAZA_SPAN("backend conectar", "backend");
+            latenciaConectar.aplicar();
+        }
         
         conectado = true;
-        std::cout << "✅ Conexión establecida exitosamente\n";
+        salida() << "✅ Conexión establecida exitosamente\n";
         return true;
     }
     
@@ -60,12 +125,12 @@ public:
             return false;
         }
         
-        std::cout << "\n🔌 Cerrando conexión a la base de datos...\n";
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        salida() << "\n🔌 Cerrando conexión a la base de datos...\n";
+        latenciaDesconectar.aplicar();
         
         conectado = false;
-        std::cout << "✅ Conexión cerrada exitosamente\n";
-        std::cout << "   Consultas ejecutadas: " << consultasEjecutadas << "\n";
+        salida() << "✅ Conexión cerrada exitosamente\n";
+        salida() << "   Consultas ejecutadas: " << consultasEjecutadas << "\n";
         return true;
     }
     
@@ -78,24 +143,195 @@ public:
         std::cout << "Base de datos: " << baseDatos << "\n";
         std::cout << "Usuario: " << usuario << "\n";
         std::cout << "Consultas ejecutadas: " << consultasEjecutadas << "\n";
+        std::cout << "Cortacircuitos: " << nombreEstadoCircuito(circuito.getEstado()) << "\n";
         std::cout << std::string(60, '=') << "\n";
         return conectado;
     }
     
     std::string ejecutarConsulta(const std::string& consulta) {
+        TRAZA_SPAN("ConexionBD::ejecutarConsulta", "bd");
+        CronometroMetrica cronometro(metricaLatencia);
         if (!conectado) {
             std::cout << "❌ Error: No hay conexión activa. Debes conectar primero.\n";
             return "";
         }
         
-        std::cout << "\n📊 Ejecutando consulta: " << consulta << "\n";
-        std::this_thread::sleep_for(std::chrono::milliseconds(300));
-        consultasEjecutadas++;
-        std::cout << "✅ Consulta ejecutada exitosamente (#" << consultasEjecutadas << ")\n";
+        salida() << "\n📊 Ejecutando consulta: " << consulta << "\n";
+        if (diario && AlmacenLocal::esEscritura(consulta)) {
+            // Con almacén local la espera es la del fdatasync de su grupo
+            TRAZA_SPAN("diario confirmación", "backend");
+            std::future<uint64_t> confirmada = anotar(consulta);
+            if (!confirmada.valid()) return "";
+            try {
+                confirmada.get();
+            } catch (const std::exception& e) {
+                std::cout << "❌ Error: " << e.what() << "\n";
+                return "";
+            }
+        } else {
+            TRAZA_SPAN("backend consulta", "backend");
+            latenciaConsulta.aplicar();
+        }
+        return completarConsulta();
+    }
+    
+    // Versión asíncrona de una escritura: el futuro se resuelve con su número
+    // de secuencia cuando el grupo que la contiene está en disco. Sin almacén
+    // abierto, sin conexión o con una sentencia que no es INSERT devuelve un
+    // futuro no válido.
+    std::future<uint64_t> escribir(const std::string& sql) {
+        TRAZA_SPAN("ConexionBD::escribir", "bd");
+        if (!conectado || !diario) {
+            std::cout << "❌ Error: hace falta conexión activa y almacén abierto para escribir.\n";
+            return std::future<uint64_t>();
+        }
+        salida() << "\n📝 Escritura: " << sql << "\n";
+        return anotar(sql);
+    }
+    
+    // Reconstruye el almacén reproduciendo el diario de `ruta` y lo deja
+    // abierto para nuevas escrituras. No debe haber escrituras en curso.
+    bool abrirAlmacen(const std::string& ruta, PoliticaSincronizacion politica = SINCRONIZAR_EN_GRUPO) {
+        cerrarAlmacen();
+        almacen.vaciar();
+        diario.reset(new DiarioEscrituras(ruta, politica));
+        escriturasRecuperadas = diario->reproducir([this](const std::string& sql) { almacen.aplicar(sql); });
+        if (!diario->abrir()) {
+            std::cout << "❌ Error: no se pudo abrir el diario " << ruta << "\n";
+            diario.reset();
+            return false;
+        }
+        salida() << "📒 Diario " << ruta << ": " << escriturasRecuperadas << " escrituras recuperadas\n";
+        return true;
+    }
+    
+    // Espera a que lo pendiente esté en disco y cierra el diario
+    void cerrarAlmacen() { diario.reset(); }
+    
+    // Consulta con latencia acotada:
+    //  - plazo explícito en `opciones` o, si es cero, timeout adaptativo (p99 observado x2)
+    //  - con el cortacircuitos abierto se rechaza sin tocar el backend
+    //  - si es idempotente y el primer intento tarda más que el p95, se lanza
+    //    un segundo intento y gana el que responda antes
+    // El backend es simulado: la latencia de cada intento sale de su modelo y
+    // solo se espera hasta la primera respuesta o hasta el plazo.
+    RespuestaConsulta ejecutarConsultaProtegida(const std::string& sql,
+                                                const OpcionesConsulta& opciones = OpcionesConsulta()) {
+        TRAZA_SPAN("ConexionBD::ejecutarConsultaProtegida", "bd");
+        RespuestaConsulta respuesta;
+        respuesta.plazo = opciones.plazo > Duracion::zero() ? opciones.plazo : estimador.timeoutAdaptativo();
+        if (!conectado) {
+            respuesta.estado = CONSULTA_SIN_CONEXION;
+            return respuesta;
+        }
+        if (!circuito.permitir()) {
+            salida() << "⛔ Cortacircuitos abierto, consulta rechazada: " << sql << "\n";
+            respuesta.estado = CONSULTA_RECHAZADA;
+            return respuesta;
+        }
+        
+        salida() << "\n📊 Ejecutando consulta protegida: " << sql << "\n";
+        Duracion tardanza = latenciaConsulta.muestrear();
+        bool error = fallos.falla();
+        if (opciones.idempotente) {
+            Duracion retrasoCobertura = estimador.percentil(0.95);
+            if (tardanza > retrasoCobertura && retrasoCobertura < respuesta.plazo) {
+                Duracion segundo = retrasoCobertura + latenciaConsulta.muestrear();
+                if (segundo < tardanza) {
+                    tardanza = segundo;
+                    error = fallos.falla();
+                    respuesta.cubierta = true;
+                }
+            }
+        }
         
-        return "Resultado de la consulta #" + std::to_string(consultasEjecutadas);
+        Reloj& reloj = EntornoLatencia::obtenerInstancia()->getReloj();
+        if (tardanza > respuesta.plazo) {
+            {
+                TRAZA_SPAN("backend consulta (timeout)", "backend");
+                reloj.esperar(respuesta.plazo);
+            }
+            salida() << "⏱️  Plazo agotado tras " << respuesta.plazo.count() / 1000000 << " ms\n";
+            respuesta.estado = CONSULTA_TIMEOUT;
+            respuesta.latencia = respuesta.plazo;
+            estimador.registrarTimeout(respuesta.plazo);
+            circuito.registrar(false);
+            return respuesta;
+        }
+        {
+            TRAZA_SPAN("backend consulta", "backend");
+            reloj.esperar(tardanza);
+        }
+        respuesta.latencia = tardanza;
+        estimador.registrar(tardanza);
+        circuito.registrar(!error);
+        if (error) {
+            salida() << "❌ El backend devolvió un error\n";
+            respuesta.estado = CONSULTA_ERROR;
+            return respuesta;
+        }
+        respuesta.resultado = completarConsulta();
+        respuesta.estado = CONSULTA_OK;
+        return respuesta;
     }
     
+    // Resultado tabular: las filas se escriben en la arena del resultado y se
+    // leen como vistas sin copias; todo se libera al destruir el resultado.
+    ResultadoConsulta consultar(const std::string& sql) {
+        TRAZA_SPAN("ConexionBD::consultar", "bd");
+        ResultadoConsulta resultado;
+        if (!conectado) {
+            std::cout << "❌ Error: No hay conexión activa. Debes conectar primero.\n";
+            return resultado;
+        }
+        
+        salida() << "\n📊 Ejecutando consulta: " << sql << "\n";
+        {
+            TRAZA_SPAN("backend consulta", "backend");
+            latenciaConsulta.aplicar();
+        }
+        TablaSimulada tabla = TablaSimulada::desdeConsulta(sql);
+        tabla.llenar(resultado, 0, tabla.getNumFilas());
+        resultado.setResumen(completarConsulta());
+        return resultado;
+    }
+    
+    // Cursor por lotes para resultados grandes: la memoria queda acotada por
+    // tamLote y lotesPrefetch, no por el número total de filas
+    std::unique_ptr<CursorConsulta> abrirCursor(const std::string& sql, long tamLote = 1000,
+                                                size_t lotesPrefetch = 2) {
+        TRAZA_SPAN("ConexionBD::abrirCursor", "bd");
+        if (!conectado) {
+            std::cout << "❌ Error: No hay conexión activa. Debes conectar primero.\n";
+            return nullptr;
+        }
+        
+        salida() << "\n📊 Abriendo cursor: " << sql << " (lotes de " << tamLote << " filas)\n";
+        {
+            TRAZA_SPAN("backend consulta", "backend");
+            latenciaConsulta.aplicar();
+        }
+        completarConsulta();
+        return std::unique_ptr<CursorConsulta>(
+            new CursorConsulta(TablaSimulada::desdeConsulta(sql), tamLote, lotesPrefetch, latenciaLote));
+    }
+    
+#if defined(__cpp_impl_coroutine)
+    // Versión awaitable: `co_await conexion->consulta(sql)` suspende la
+    // corrutina durante la latencia simulada en lugar de bloquear el hilo.
+    EsperaSimulada<std::string> consulta(const std::string& sql) {
+        if (!conectado) {
+            return EsperaSimulada<std::string>(Duracion::zero(), [] {
+                std::cout << "❌ Error: No hay conexión activa. Debes conectar primero.\n";
+                return std::string();
+            });
+        }
+        salida() << "\n📊 Consulta asíncrona: " << sql << "\n";
+        return EsperaSimulada<std::string>(latenciaConsulta.muestrear(),
+                                           [this] { return completarConsulta(); });
+    }
+#endif
+    
     bool configurar(const std::string& nuevoHost = "", int nuevoPuerto = 0,
                     const std::string& nuevaBD = "", const std::string& nuevoUsuario = "") {
         if (conectado) {
@@ -108,10 +344,40 @@ public:
         if (!nuevaBD.empty()) baseDatos = nuevaBD;
         if (!nuevoUsuario.empty()) usuario = nuevoUsuario;
         
-        std::cout << "✅ Configuración actualizada correctamente\n";
+        salida() << "✅ Configuración actualizada correctamente\n";
         return true;
     }
     
+    void setSilencioso(bool valor) { silencioso = valor; }
+    int getConsultasEjecutadas() const { return consultasEjecutadas; }
+    size_t contarFilas(const std::string& tabla) const { return almacen.contarFilas(tabla); }
+    size_t getEscriturasRecuperadas() const { return escriturasRecuperadas; }
+    const DiarioEscrituras* getDiario() const { return diario.get(); }
+    
+    // Sustituye el modelo de latencia simulada (p. ej. LatenciaCero en benchmarks)
+    void setLatenciaConsulta(std::shared_ptr<ModeloLatencia> modelo) {
+        latenciaConsulta.setModelo(modelo);
+    }
+    
+    // Backend simulado que falla con probabilidad p en cada intento
+    void setProbabilidadError(double p) {
+        fallos.setProbabilidad(p);
+    }
+    
+    EstadoCircuito getEstadoCircuito() const { return circuito.getEstado(); }
+    unsigned long getAperturasCircuito() const { return circuito.getAperturas(); }
+    Duracion getTimeoutAdaptativo() const { return estimador.timeoutAdaptativo(); }
+    
+    // Latencia de traer cada lote de un cursor
+    void setLatenciaLote(std::shared_ptr<ModeloLatencia> modelo) {
+        latenciaLote.setModelo(modelo);
+    }
+    
+    void setLatenciaConexion(std::shared_ptr<ModeloLatencia> modelo) {
+        latenciaConectar.setModelo(modelo);
+        latenciaDesconectar.setModelo(modelo);
+    }
+    
     static void destruirInstancia() {
         if (instancia != nullptr) {
             delete instancia;
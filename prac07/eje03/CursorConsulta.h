@@ -0,0 +1,181 @@
+#ifndef CURSORCONSULTA_H
+#define CURSORCONSULTA_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "../comun/ModeloLatencia.h"
+#include "../comun/Traza.h"
+#include "ResultadoConsulta.h"
+#include "TablaSimulada.h"
+
+// ---------------------------------------------------------------------------
+// Cursor sobre un resultado grande, leído por lotes de `tamLote` filas. Cada
+// lote es un ResultadoConsulta con su propia arena.
+//
+// - Con lotesPrefetch > 0 un hilo productor trae los lotes siguientes
+//   mientras se procesa el actual; si la cola llega a lotesPrefetch lotes,
+//   el productor espera (contrapresión). En memoria hay como mucho
+//   lotesPrefetch + 1 lotes (el actual, los de la cola y el que se está
+//   trayendo), sea cual sea el tamaño del resultado.
+// - Con lotesPrefetch = 0 cada lote se trae al pedirlo, en el hilo que lee.
+//
+// Las filas y vistas de un lote dejan de ser válidas al pedir el siguiente.
+// El cursor copia el inyector de latencia de la conexión al abrirse: sigue
+// siendo válido tras ConexionBD::destruirInstancia(), y un setLatenciaLote()
+// posterior no afecta a los cursores ya abiertos.
+// ---------------------------------------------------------------------------
+class CursorConsulta {
+private:
+    TablaSimulada tabla;
+    long tamLote;
+    size_t lotesPrefetch;
+    InyectorLatencia latenciaLote;
+    long siguienteFila;
+
+    std::unique_ptr<ResultadoConsulta> loteActual;
+    size_t filaEnLote;
+
+    mutable std::mutex mutexCola;
+    std::condition_variable hayLote;
+    std::condition_variable hayHueco;
+    std::deque<std::unique_ptr<ResultadoConsulta> > cola;
+    bool produciendo;
+    bool terminado;
+    bool cancelado;
+    std::thread productor;
+
+    size_t lotesLeidos;
+    size_t picoLotesEnCola;
+    size_t bytesEnMemoria;
+    size_t picoBytesEnMemoria;
+
+    // El lote cuenta en memoria desde que existe su arena, también mientras
+    // dura la transferencia y antes de entrar en la cola
+    std::unique_ptr<ResultadoConsulta> producirLote() {
+        if (siguienteFila >= tabla.getNumFilas()) return nullptr;
+        TRAZA_SPAN("CursorConsulta::producirLote", "bd");
+        std::unique_ptr<ResultadoConsulta> lote(new ResultadoConsulta());
+        tabla.llenar(*lote, siguienteFila, siguienteFila + tamLote);
+        siguienteFila += tamLote;
+        {
+            std::lock_guard<std::mutex> lock(mutexCola);
+            contarBytes(*lote, true);
+        }
+        latenciaLote.aplicar();
+        return lote;
+    }
+
+    // Llamar con mutexCola tomado
+    void contarBytes(const ResultadoConsulta& lote, bool entra) {
+        if (entra) {
+            bytesEnMemoria += lote.getBytesArena();
+            if (bytesEnMemoria > picoBytesEnMemoria) picoBytesEnMemoria = bytesEnMemoria;
+        } else {
+            bytesEnMemoria -= lote.getBytesArena();
+        }
+    }
+
+    void bucleProductor() {
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutexCola);
+                hayHueco.wait(lock, [this] { return cancelado || cola.size() < lotesPrefetch; });
+                if (cancelado) return;
+            }
+            std::unique_ptr<ResultadoConsulta> lote = producirLote();
+
+            std::lock_guard<std::mutex> lock(mutexCola);
+            if (!lote) {
+                terminado = true;
+                hayLote.notify_all();
+                return;
+            }
+            cola.push_back(std::move(lote));
+            if (cola.size() > picoLotesEnCola) picoLotesEnCola = cola.size();
+            hayLote.notify_one();
+        }
+    }
+
+public:
+    CursorConsulta(const TablaSimulada& t, long filasPorLote, size_t prefetch, const InyectorLatencia& latencia)
+        : tabla(t), tamLote(filasPorLote > 0 ? filasPorLote : 1), lotesPrefetch(prefetch),
+          latenciaLote(latencia), siguienteFila(0), filaEnLote(0),
+          produciendo(prefetch > 0), terminado(false), cancelado(false),
+          lotesLeidos(0), picoLotesEnCola(0), bytesEnMemoria(0), picoBytesEnMemoria(0) {
+        if (produciendo) productor = std::thread(&CursorConsulta::bucleProductor, this);
+    }
+
+    CursorConsulta(const CursorConsulta&) = delete;
+    CursorConsulta& operator=(const CursorConsulta&) = delete;
+
+    ~CursorConsulta() { cerrar(); }
+
+    // Suelta el lote actual y devuelve el siguiente, o nullptr al terminar
+    const ResultadoConsulta* siguienteLote() {
+        std::unique_lock<std::mutex> lock(mutexCola);
+        if (loteActual) {
+            contarBytes(*loteActual, false);
+            loteActual.reset();
+        }
+        filaEnLote = 0;
+
+        if (!produciendo) {
+            if (cancelado) return nullptr;
+            lock.unlock();
+            std::unique_ptr<ResultadoConsulta> lote = producirLote();
+            lock.lock();
+            if (!lote) return nullptr;
+            loteActual = std::move(lote);
+        } else {
+            hayLote.wait(lock, [this] { return !cola.empty() || terminado || cancelado; });
+            if (cola.empty()) return nullptr;
+            loteActual = std::move(cola.front());
+            cola.pop_front();
+            hayHueco.notify_one();
+        }
+        lotesLeidos++;
+        return loteActual.get();
+    }
+
+    // Recorrido fila a fila; cambia de lote cuando se agota el actual
+    bool siguiente(Fila& fila) {
+        while (!loteActual || filaEnLote >= loteActual->getNumFilas()) {
+            if (siguienteLote() == nullptr) return false;
+        }
+        fila = loteActual->getFila(filaEnLote++);
+        return true;
+    }
+
+    // Detiene el productor; los lotes pendientes se descartan
+    void cerrar() {
+        {
+            std::lock_guard<std::mutex> lock(mutexCola);
+            cancelado = true;
+        }
+        hayHueco.notify_all();
+        hayLote.notify_all();
+        if (productor.joinable()) productor.join();
+    }
+
+    size_t getLotesLeidos() const {
+        std::lock_guard<std::mutex> lock(mutexCola);
+        return lotesLeidos;
+    }
+    
+    size_t getPicoLotesEnCola() const {
+        std::lock_guard<std::mutex> lock(mutexCola);
+        return picoLotesEnCola;
+    }
+    
+    size_t getPicoBytesEnMemoria() const {
+        std::lock_guard<std::mutex> lock(mutexCola);
+        return picoBytesEnMemoria;
+    }
+
+    long getTamLote() const { return tamLote; }
+};
+
+#endif
@@ -0,0 +1,307 @@
+#ifndef DIARIOESCRITURAS_H
+#define DIARIOESCRITURAS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "../comun/Metricas.h"
+
+enum PoliticaSincronizacion {
+    SINCRONIZAR_EN_GRUPO,          // un fdatasync cubre todas las escrituras acumuladas
+    SINCRONIZAR_CADA_ESCRITURA     // un fdatasync por escritura (referencia)
+};
+
+// Diario de escritura anticipada (write-ahead log) con confirmación en grupo.
+//
+// Cada escritura se codifica como registro [u32 longitud | u32 crc32 | datos]
+// (little-endian) y se añade al buffer activo; el llamador recibe un futuro.
+// Un hilo confirmador intercambia el buffer activo por uno vacío, lo escribe
+// con un solo write() y hace un único fdatasync: cuando vuelve, resuelve los
+// futuros de todo el grupo con su número de secuencia (LSN), después de
+// ejecutar en orden de LSN el `alConfirmar` de cada escritura. Mientras
+// sincroniza, las escrituras nuevas se acumulan en el otro buffer y forman el
+// grupo siguiente: cuanto más lento el disco, más grandes los grupos.
+//
+// reproducir() recorre el archivo al abrirlo y entrega cada registro válido;
+// un registro incompleto, vacío o con crc erróneo (caída a mitad de un write)
+// marca el final y se recorta. Por eso, si un write() falla a medias se recorta
+// el archivo hasta el último grupo confirmado antes de seguir; si no se puede
+// recortar, o falla el fdatasync (las páginas sucias pueden haberse perdido),
+// el diario queda fallido y rechaza las escrituras siguientes.
+class DiarioEscrituras {
+private:
+    struct Pendiente {
+        uint64_t lsn;
+        std::promise<uint64_t> promesa;
+        std::function<void()> alConfirmar;
+    };
+
+    std::string ruta;
+    PoliticaSincronizacion politica;
+    int fd;
+    off_t offsetConfirmado;          // fin del último grupo en disco
+    std::atomic<bool> fallido;       // el archivo ya no es de fiar: se rechaza todo
+
+    std::mutex mutexBuffer;
+    std::condition_variable hayEscrituras;
+    std::vector<char> activo;
+    std::vector<Pendiente> pendientes;
+    uint64_t siguienteLsn;
+    bool detenido;
+    std::thread confirmador;
+
+    std::mutex mutexDirecto;   // SINCRONIZAR_CADA_ESCRITURA
+
+    std::atomic<uint64_t> escrituras;
+    std::atomic<uint64_t> sincronizaciones;
+    std::atomic<uint64_t> grupoMaximo;
+    Contador metricaEscrituras;
+    Contador metricaSincronizaciones;
+
+    struct TablaCrc {
+        uint32_t v[256];
+        TablaCrc() {
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                v[i] = c;
+            }
+        }
+    };
+
+    static uint32_t crc32(const char* datos, size_t n) {
+        static const TablaCrc tabla;
+        uint32_t c = 0xFFFFFFFFu;
+        for (size_t i = 0; i < n; i++) c = tabla.v[(c ^ static_cast<uint8_t>(datos[i])) & 0xFF] ^ (c >> 8);
+        return c ^ 0xFFFFFFFFu;
+    }
+
+    static void anadirU32(std::vector<char>& destino, uint32_t v) {
+        for (int i = 0; i < 4; i++) destino.push_back(static_cast<char>(v >> (8 * i)));
+    }
+
+    static uint32_t leerU32(const char* p) {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; i++) v |= static_cast<uint32_t>(static_cast<uint8_t>(p[i])) << (8 * i);
+        return v;
+    }
+
+    static void codificar(std::vector<char>& destino, const std::string& datos) {
+        anadirU32(destino, static_cast<uint32_t>(datos.size()));
+        anadirU32(destino, crc32(datos.data(), datos.size()));
+        destino.insert(destino.end(), datos.begin(), datos.end());
+    }
+
+    // write() completo + fdatasync. Nunca deja un registro a medias detrás
+    // del que se sigan añadiendo grupos.
+    bool persistir(const std::vector<char>& datos) {
+        if (fallido.load()) return false;
+        size_t escrito = 0;
+        while (escrito < datos.size()) {
+            ssize_t n = ::write(fd, datos.data() + escrito, datos.size() - escrito);
+            if (n < 0) {
+                if (::ftruncate(fd, offsetConfirmado) != 0) fallido.store(true);
+                return false;
+            }
+            escrito += static_cast<size_t>(n);
+        }
+        sincronizaciones.fetch_add(1, std::memory_order_relaxed);
+        metricaSincronizaciones.incrementar();
+        if (::fdatasync(fd) != 0) {
+            // Se intenta quitar la cola, pero el diario queda fallido igualmente
+            int recorte = ::ftruncate(fd, offsetConfirmado);
+            (void)recorte;
+            fallido.store(true);
+            return false;
+        }
+        offsetConfirmado += static_cast<off_t>(datos.size());
+        return true;
+    }
+
+    std::exception_ptr errorEscritura() const {
+        return std::make_exception_ptr(std::runtime_error(
+            (fallido.load() ? "DiarioEscrituras: diario fallido " : "DiarioEscrituras: fallo al escribir ") + ruta));
+    }
+
+    // El registro ya está en disco; si `alConfirmar` lanza, su futuro lleva
+    // la excepción y el confirmador sigue con el resto del grupo
+    static void confirmarPendiente(std::promise<uint64_t>& promesa, uint64_t lsn,
+                                   const std::function<void()>& alConfirmar) {
+        try {
+            if (alConfirmar) alConfirmar();
+        } catch (...) {
+            promesa.set_exception(std::current_exception());
+            return;
+        }
+        promesa.set_value(lsn);
+    }
+
+    void bucleConfirmacion() {
+        std::vector<char> grupo;
+        std::vector<Pendiente> confirmar;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutexBuffer);
+                hayEscrituras.wait(lock, [this] { return detenido || !pendientes.empty(); });
+                if (pendientes.empty()) return;
+                grupo.swap(activo);
+                confirmar.swap(pendientes);
+            }
+            // Sin el mutex: los escritores siguen llenando el buffer activo
+            bool ok = persistir(grupo);
+            uint64_t tamano = confirmar.size();
+            uint64_t maximo = grupoMaximo.load(std::memory_order_relaxed);
+            if (tamano > maximo) grupoMaximo.store(tamano, std::memory_order_relaxed);
+            for (size_t i = 0; i < confirmar.size(); i++) {
+                if (ok) {
+                    confirmarPendiente(confirmar[i].promesa, confirmar[i].lsn, confirmar[i].alConfirmar);
+                } else {
+                    confirmar[i].promesa.set_exception(errorEscritura());
+                }
+            }
+            grupo.clear();
+            confirmar.clear();
+        }
+    }
+
+public:
+    explicit DiarioEscrituras(const std::string& rutaArchivo,
+                              PoliticaSincronizacion p = SINCRONIZAR_EN_GRUPO)
+        : ruta(rutaArchivo), politica(p), fd(-1), offsetConfirmado(0), fallido(false),
+          siguienteLsn(0), detenido(true),
+          escrituras(0), sincronizaciones(0), grupoMaximo(0),
+          metricaEscrituras("prac07_diario_escrituras_total", "Escrituras añadidas al diario"),
+          metricaSincronizaciones("prac07_diario_fsync_total", "Llamadas a fdatasync del diario") {}
+
+    ~DiarioEscrituras() { cerrar(); }
+
+    DiarioEscrituras(const DiarioEscrituras&) = delete;
+    DiarioEscrituras& operator=(const DiarioEscrituras&) = delete;
+
+    // Entrega cada registro válido en orden y recorta la cola dañada.
+    // Devuelve el número de registros reproducidos.
+    size_t reproducir(const std::function<void(const std::string&)>& aplicar) {
+        int lectura = ::open(ruta.c_str(), O_RDONLY);
+        if (lectura < 0) return 0;
+        std::vector<char> contenido;
+        char bloque[65536];
+        ssize_t n;
+        while ((n = ::read(lectura, bloque, sizeof(bloque))) > 0) contenido.insert(contenido.end(), bloque, bloque + n);
+        ::close(lectura);
+
+        size_t pos = 0, registros = 0;
+        while (pos + 8 <= contenido.size()) {
+            uint32_t longitud = leerU32(&contenido[pos]);
+            uint32_t crc = leerU32(&contenido[pos + 4]);
+            // Un registro vacío no se escribe nunca: ceros tras una caída
+            if (longitud == 0 || longitud > contenido.size() - pos - 8) break;
+            const char* datos = contenido.data() + pos + 8;
+            if (crc32(datos, longitud) != crc) break;
+            aplicar(std::string(datos, longitud));
+            pos += 8 + longitud;
+            registros++;
+        }
+        if (pos < contenido.size() && ::truncate(ruta.c_str(), static_cast<off_t>(pos)) != 0) {
+            std::cout << "⚠️  No se pudo recortar la cola dañada de " << ruta << "\n";
+        }
+        siguienteLsn = registros;
+        return registros;
+    }
+
+    bool abrir() {
+        if (fd >= 0) return true;
+        fd = ::open(ruta.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) return false;
+        offsetConfirmado = ::lseek(fd, 0, SEEK_END);
+        detenido = false;
+        if (politica == SINCRONIZAR_EN_GRUPO) {
+            confirmador = std::thread(&DiarioEscrituras::bucleConfirmacion, this);
+        }
+        return true;
+    }
+
+    // Confirma lo pendiente, detiene el confirmador y cierra el archivo
+    void cerrar() {
+        {
+            std::lock_guard<std::mutex> lock(mutexBuffer);
+            if (detenido) return;
+            detenido = true;
+        }
+        hayEscrituras.notify_one();
+        if (confirmador.joinable()) confirmador.join();
+        ::close(fd);
+        fd = -1;
+    }
+
+    // El futuro se resuelve con el LSN cuando el registro está en disco.
+    // `alConfirmar` se ejecuta justo antes, solo si la escritura llegó al
+    // disco y en orden de LSN (p. ej. para aplicarla al almacén): nadie ve
+    // datos que una caída podría perder. Si lanza, el futuro lleva su
+    // excepción. Las escrituras vacías se rechazan (invalid_argument).
+    std::future<uint64_t> anadir(const std::string& datos,
+                                 const std::function<void()>& alConfirmar = std::function<void()>()) {
+        if (datos.empty()) {
+            std::promise<uint64_t> promesa;
+            promesa.set_exception(std::make_exception_ptr(
+                std::invalid_argument("DiarioEscrituras: escritura vacía")));
+            return promesa.get_future();
+        }
+        escrituras.fetch_add(1, std::memory_order_relaxed);
+        metricaEscrituras.incrementar();
+        if (politica == SINCRONIZAR_CADA_ESCRITURA) {
+            std::promise<uint64_t> promesa;
+            std::lock_guard<std::mutex> lock(mutexDirecto);
+            std::vector<char> registro;
+            codificar(registro, datos);
+            uint64_t lsn = ++siguienteLsn;
+            if (fd >= 0 && persistir(registro)) {
+                confirmarPendiente(promesa, lsn, alConfirmar);
+            } else {
+                promesa.set_exception(errorEscritura());
+            }
+            return promesa.get_future();
+        }
+
+        std::future<uint64_t> futuro;
+        {
+            std::lock_guard<std::mutex> lock(mutexBuffer);
+            Pendiente p;
+            if (detenido) {
+                p.promesa.set_exception(std::make_exception_ptr(
+                    std::runtime_error("DiarioEscrituras: diario cerrado")));
+                return p.promesa.get_future();
+            }
+            if (fallido.load()) {
+                p.promesa.set_exception(errorEscritura());
+                return p.promesa.get_future();
+            }
+            codificar(activo, datos);
+            p.lsn = ++siguienteLsn;
+            p.alConfirmar = alConfirmar;
+            futuro = p.promesa.get_future();
+            pendientes.push_back(std::move(p));
+        }
+        hayEscrituras.notify_one();
+        return futuro;
+    }
+
+    uint64_t getEscrituras() const { return escrituras.load(std::memory_order_relaxed); }
+    uint64_t getSincronizaciones() const { return sincronizaciones.load(std::memory_order_relaxed); }
+    bool getFallido() const { return fallido.load(); }
+    uint64_t getGrupoMaximo() const { return grupoMaximo.load(std::memory_order_relaxed); }
+    const std::string& getRuta() const { return ruta; }
+};
+
+#endif
@@ -0,0 +1,262 @@
+#ifndef PROTECCIONCONSULTAS_H
+#define PROTECCIONCONSULTAS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+#include "../comun/ModeloLatencia.h"
+
+// ---------------------------------------------------------------------------
+// Piezas para acotar la latencia de ConexionBD::ejecutarConsultaProtegida():
+// plazos por consulta, timeout adaptativo, lecturas cubiertas (hedged) y
+// cortacircuitos. El tiempo sale del reloj de EntornoLatencia, así que todo
+// funciona igual con LATENCIA_RELOJ=virtual.
+// ---------------------------------------------------------------------------
+
+enum EstadoConsulta {
+    CONSULTA_OK,
+    CONSULTA_TIMEOUT,
+    CONSULTA_ERROR,
+    CONSULTA_RECHAZADA,       // cortacircuitos abierto
+    CONSULTA_SIN_CONEXION
+};
+
+inline const char* nombreEstadoConsulta(EstadoConsulta estado) {
+    switch (estado) {
+        case CONSULTA_OK: return "OK";
+        case CONSULTA_TIMEOUT: return "TIMEOUT";
+        case CONSULTA_ERROR: return "ERROR";
+        case CONSULTA_RECHAZADA: return "RECHAZADA";
+        case CONSULTA_SIN_CONEXION: return "SIN_CONEXION";
+    }
+    return "?";
+}
+
+struct OpcionesConsulta {
+    Duracion plazo;       // cero = timeout adaptativo
+    bool idempotente;     // permite lanzar un segundo intento (lectura cubierta)
+
+    OpcionesConsulta() : plazo(Duracion::zero()), idempotente(false) {}
+
+    static OpcionesConsulta lectura() {
+        OpcionesConsulta opciones;
+        opciones.idempotente = true;
+        return opciones;
+    }
+};
+
+struct RespuestaConsulta {
+    EstadoConsulta estado;
+    std::string resultado;
+    Duracion latencia;
+    Duracion plazo;
+    bool cubierta;        // respondió el segundo intento
+
+    RespuestaConsulta()
+        : estado(CONSULTA_OK), latencia(Duracion::zero()), plazo(Duracion::zero()), cubierta(false) {}
+};
+
+// Ventana deslizante de latencias observadas. Una consulta que agota su
+// plazo solo dice que la latencia fue al menos ese plazo: entra como muestra
+// censurada, que nunca sube el timeout adaptativo por encima del actual. Si
+// entrara con el plazo, cada timeout alargaría el siguiente (p99 × factor) y
+// el plazo seguiría alto con el backend ya recuperado.
+class EstimadorLatencia {
+private:
+    static const size_t MUESTRAS_MINIMAS = 20;
+
+    mutable std::mutex mutexVentana;
+    std::vector<int64_t> ventana;
+    size_t siguiente;
+    size_t ocupadas;
+    double factor;
+    Duracion minimo;
+    Duracion maximo;
+    Duracion inicial;
+    std::atomic<uint64_t> timeouts;
+
+public:
+    EstimadorLatencia(size_t capacidad = 256, double multiplicador = 2.0,
+                      Duracion timeoutMinimo = std::chrono::milliseconds(10),
+                      Duracion timeoutMaximo = std::chrono::milliseconds(2000),
+                      Duracion timeoutInicial = std::chrono::milliseconds(1000))
+        : ventana(capacidad, 0), siguiente(0), ocupadas(0), factor(multiplicador),
+          minimo(timeoutMinimo), maximo(timeoutMaximo), inicial(timeoutInicial), timeouts(0) {}
+
+    void registrar(Duracion latencia) {
+        std::lock_guard<std::mutex> lock(mutexVentana);
+        ventana[siguiente] = latencia.count();
+        siguiente = (siguiente + 1) % ventana.size();
+        if (ocupadas < ventana.size()) ocupadas++;
+    }
+
+    void registrarTimeout(Duracion plazo) {
+        Duracion tope(static_cast<int64_t>(timeoutAdaptativo().count() / factor));
+        registrar(std::min(plazo, tope));
+        timeouts.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Percentil p (0..1) de la ventana; sin muestras suficientes, el timeout inicial
+    Duracion percentil(double p) const {
+        std::vector<int64_t> copia;
+        {
+            std::lock_guard<std::mutex> lock(mutexVentana);
+            if (ocupadas < MUESTRAS_MINIMAS) return inicial;
+            copia.assign(ventana.begin(), ventana.begin() + ocupadas);
+        }
+        size_t k = static_cast<size_t>(p * (copia.size() - 1));
+        std::nth_element(copia.begin(), copia.begin() + k, copia.end());
+        return Duracion(copia[k]);
+    }
+
+    // p99 observado por un margen, acotado a [mínimo, máximo]
+    Duracion timeoutAdaptativo() const {
+        Duracion t(static_cast<int64_t>(percentil(0.99).count() * factor));
+        return std::max(minimo, std::min(maximo, t));
+    }
+
+    uint64_t getTimeouts() const { return timeouts.load(std::memory_order_relaxed); }
+};
+
+enum EstadoCircuito {
+    CIRCUITO_CERRADO,
+    CIRCUITO_ABIERTO,
+    CIRCUITO_SEMIABIERTO
+};
+
+inline const char* nombreEstadoCircuito(EstadoCircuito estado) {
+    switch (estado) {
+        case CIRCUITO_CERRADO: return "CERRADO";
+        case CIRCUITO_ABIERTO: return "ABIERTO";
+        case CIRCUITO_SEMIABIERTO: return "SEMIABIERTO";
+    }
+    return "?";
+}
+
+// Cortacircuitos por tasa de error sobre las últimas `tamVentana` consultas.
+// Abierto: rechaza sin tocar el backend durante `enfriamiento`. Después deja
+// pasar una sola consulta de prueba: si sale bien se cierra, si no, se reabre.
+class Cortacircuitos {
+private:
+    mutable std::mutex mutexEstado;
+    std::vector<bool> resultados;      // true = fallo
+    size_t siguiente;
+    size_t ocupadas;
+    size_t fallos;
+    double umbralError;
+    size_t minimoConsultas;
+    Duracion enfriamiento;
+
+    EstadoCircuito estado;
+    Duracion abiertoDesde;
+    bool pruebaEnCurso;
+    unsigned long aperturas;
+    unsigned long rechazadas;
+
+    static Duracion ahora() { return EntornoLatencia::obtenerInstancia()->getReloj().ahora(); }
+
+    void vaciarVentana() {
+        std::fill(resultados.begin(), resultados.end(), false);
+        siguiente = ocupadas = fallos = 0;
+    }
+
+    void abrir() {
+        estado = CIRCUITO_ABIERTO;
+        abiertoDesde = ahora();
+        pruebaEnCurso = false;
+        aperturas++;
+    }
+
+public:
+    Cortacircuitos(size_t tamVentana = 20, double umbral = 0.5, size_t minimo = 10,
+                   Duracion tiempoEnfriamiento = std::chrono::milliseconds(2000))
+        : resultados(tamVentana, false), siguiente(0), ocupadas(0), fallos(0),
+          umbralError(umbral), minimoConsultas(minimo), enfriamiento(tiempoEnfriamiento),
+          estado(CIRCUITO_CERRADO), abiertoDesde(Duracion::zero()), pruebaEnCurso(false),
+          aperturas(0), rechazadas(0) {}
+
+    // ¿Puede esta consulta ir al backend?
+    bool permitir() {
+        std::lock_guard<std::mutex> lock(mutexEstado);
+        if (estado == CIRCUITO_ABIERTO && ahora() - abiertoDesde >= enfriamiento) {
+            estado = CIRCUITO_SEMIABIERTO;
+        }
+        if (estado == CIRCUITO_CERRADO) return true;
+        if (estado == CIRCUITO_SEMIABIERTO && !pruebaEnCurso) {
+            pruebaEnCurso = true;
+            return true;
+        }
+        rechazadas++;
+        return false;
+    }
+
+    void registrar(bool exito) {
+        std::lock_guard<std::mutex> lock(mutexEstado);
+        if (estado == CIRCUITO_SEMIABIERTO) {
+            if (exito) {
+                estado = CIRCUITO_CERRADO;
+                pruebaEnCurso = false;
+                vaciarVentana();
+            } else {
+                abrir();
+            }
+            return;
+        }
+        if (estado != CIRCUITO_CERRADO) return;
+
+        if (ocupadas == resultados.size() && resultados[siguiente]) fallos--;
+        resultados[siguiente] = !exito;
+        if (!exito) fallos++;
+        siguiente = (siguiente + 1) % resultados.size();
+        if (ocupadas < resultados.size()) ocupadas++;
+
+        if (ocupadas >= minimoConsultas && fallos >= umbralError * ocupadas) {
+            abrir();
+            vaciarVentana();
+        }
+    }
+
+    EstadoCircuito getEstado() const {
+        std::lock_guard<std::mutex> lock(mutexEstado);
+        return estado;
+    }
+
+    unsigned long getAperturas() const {
+        std::lock_guard<std::mutex> lock(mutexEstado);
+        return aperturas;
+    }
+
+    unsigned long getRechazadas() const {
+        std::lock_guard<std::mutex> lock(mutexEstado);
+        return rechazadas;
+    }
+};
+
+// Fallos del backend simulado: cada intento falla con probabilidad p
+class FallosSimulados {
+private:
+    std::mutex mutexGenerador;
+    std::mt19937_64 generador;
+    double probabilidad;
+
+public:
+    explicit FallosSimulados(uint64_t semilla = 7) : generador(semilla), probabilidad(0.0) {}
+
+    void setProbabilidad(double p) {
+        std::lock_guard<std::mutex> lock(mutexGenerador);
+        probabilidad = p;
+    }
+
+    bool falla() {
+        std::lock_guard<std::mutex> lock(mutexGenerador);
+        if (probabilidad <= 0.0) return false;
+        return std::uniform_real_distribution<double>(0.0, 1.0)(generador) < probabilidad;
+    }
+};
+
+#endif
@@ -0,0 +1,402 @@
+#ifndef REGISTROCONEXIONES_H
+#define REGISTROCONEXIONES_H
+
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "ConexionBD.h"
+
+enum RolPool {
+    ROL_PRIMARIA,
+    ROL_REPLICA
+};
+
+struct ConfiguracionPool {
+    std::string nombre;
+    RolPool rol;
+    std::string host;
+    int puerto;
+    std::string baseDatos;
+    std::string usuario;
+    size_t conexiones;
+    std::string latenciaConsulta;   // especificación de ModeloLatencia; vacía = la del entorno
+    std::string latenciaConexion;
+};
+
+// ---------------------------------------------------------------------------
+// Pool de conexiones hacia una base de datos. Cada conexión es una instancia
+// propia de ConexionBD (silenciosa) que solo usa un hilo a la vez; si todas
+// están ocupadas, quien llega espera a que se libere una.
+// ---------------------------------------------------------------------------
+class PoolConexiones {
+private:
+    ConfiguracionPool config;
+    unsigned version;
+    std::vector<std::unique_ptr<ConexionBD> > conexiones;
+
+    std::mutex mutexLibres;
+    std::condition_variable hayLibre;
+    std::vector<ConexionBD*> libres;
+
+    std::atomic<int> enCurso;
+    std::atomic<int> picoEnCurso;
+    std::atomic<unsigned long> atendidas;
+
+    // Conecta o desconecta todas las conexiones en paralelo
+    void enParalelo(bool conectar) {
+        std::vector<std::thread> hilos;
+        for (size_t i = 0; i < conexiones.size(); i++) {
+            ConexionBD* c = conexiones[i].get();
+            hilos.emplace_back([c, conectar] {
+                if (conectar) c->conectar();
+                else c->desconectar();
+            });
+        }
+        for (auto& hilo : hilos) hilo.join();
+    }
+
+    void devolver(ConexionBD* conexion) {
+        {
+            std::lock_guard<std::mutex> lock(mutexLibres);
+            libres.push_back(conexion);
+        }
+        hayLibre.notify_one();
+        atendidas.fetch_add(1, std::memory_order_relaxed);
+        enCurso.fetch_sub(1);
+    }
+
+    struct Prestamo {
+        PoolConexiones* pool;
+        ConexionBD* conexion;
+        ~Prestamo() { pool->devolver(conexion); }
+    };
+
+public:
+    PoolConexiones(const ConfiguracionPool& c, unsigned v)
+        : config(c), version(v), enCurso(0), picoEnCurso(0), atendidas(0) {
+        size_t n = config.conexiones > 0 ? config.conexiones : 1;
+        for (size_t i = 0; i < n; i++) {
+            std::unique_ptr<ConexionBD> conexion(new ConexionBD());
+            conexion->setSilencioso(true);
+            conexion->configurar(config.host, config.puerto, config.baseDatos, config.usuario);
+            if (!config.latenciaConsulta.empty()) {
+                std::shared_ptr<ModeloLatencia> modelo = ModeloLatencia::crear(config.latenciaConsulta);
+                if (modelo) conexion->setLatenciaConsulta(modelo);
+            }
+            if (!config.latenciaConexion.empty()) {
+                std::shared_ptr<ModeloLatencia> modelo = ModeloLatencia::crear(config.latenciaConexion);
+                if (modelo) conexion->setLatenciaConexion(modelo);
+            }
+            libres.push_back(conexion.get());
+            conexiones.push_back(std::move(conexion));
+        }
+        enParalelo(true);
+    }
+
+    PoolConexiones(const PoolConexiones&) = delete;
+    PoolConexiones& operator=(const PoolConexiones&) = delete;
+
+    ~PoolConexiones() {
+        enParalelo(false);
+        std::cout << "🔌 Pool '" << config.nombre << "' v" << version << " cerrado ("
+                  << atendidas.load() << " consultas atendidas)\n";
+    }
+
+    // Ejecuta f(ConexionBD&) con una conexión libre del pool
+    template <typename F>
+    auto usar(F f) -> decltype(f(std::declval<ConexionBD&>())) {
+        int actuales = enCurso.fetch_add(1) + 1;
+        int pico = picoEnCurso.load(std::memory_order_relaxed);
+        while (actuales > pico && !picoEnCurso.compare_exchange_weak(pico, actuales)) {}
+
+        ConexionBD* conexion;
+        {
+            std::unique_lock<std::mutex> lock(mutexLibres);
+            hayLibre.wait(lock, [this] { return !libres.empty(); });
+            conexion = libres.back();
+            libres.pop_back();
+        }
+        Prestamo prestamo = {this, conexion};
+        return f(*conexion);
+    }
+
+    const ConfiguracionPool& getConfiguracion() const { return config; }
+    unsigned getVersion() const { return version; }
+    int getEnCurso() const { return enCurso.load(); }
+    int getPicoEnCurso() const { return picoEnCurso.load(); }
+    unsigned long getAtendidas() const { return atendidas.load(); }
+};
+
+// ---------------------------------------------------------------------------
+// Pools retirados pendientes de cerrar. El último shared_ptr de un pool
+// puede soltarlo cualquier hilo de petición; en vez de pagar ahí los
+// desconectar() del pool, su deleter lo encola y un hilo propio lo cierra.
+// Cuando la cola ya no está activa (registro destruido), el deleter cierra
+// el pool en el hilo que lo suelta.
+// ---------------------------------------------------------------------------
+struct ColaRetiro {
+    std::mutex mutex;
+    std::condition_variable hayPools;
+    std::vector<PoolConexiones*> pendientes;
+    bool activa;
+    ColaRetiro() : activa(true) {}
+};
+
+struct RetirarPool {
+    std::shared_ptr<ColaRetiro> cola;
+
+    void operator()(PoolConexiones* pool) const {
+        {
+            std::lock_guard<std::mutex> lock(cola->mutex);
+            if (cola->activa) {
+                cola->pendientes.push_back(pool);
+                cola->hayPools.notify_one();
+                return;
+            }
+        }
+        delete pool;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Registro de pools con nombre (Singleton thread-safe) de un único clúster:
+// una primaria y sus réplicas.
+//
+// - Las lecturas (SELECT) van a la réplica con menos consultas en curso
+//   (least-outstanding-requests); sin réplicas, a la primaria.
+// - Las escrituras van siempre a la primaria. Una segunda primaria con otro
+//   nombre se rechaza: las escrituras no pueden repartirse entre dos bases.
+// - configurarPool() reemplaza un pool en caliente: el nuevo se conecta
+//   fuera del lock y las consultas en curso terminan en el anterior, que el
+//   hilo de retiro cierra cuando su último usuario lo suelta.
+// ---------------------------------------------------------------------------
+class RegistroConexiones {
+private:
+    static std::atomic<RegistroConexiones*> instancia;
+    static std::mutex mutexInstancia;
+
+    mutable std::mutex mutexPools;
+    std::map<std::string, std::shared_ptr<PoolConexiones> > pools;
+    std::atomic<unsigned> siguienteVersion;
+    std::atomic<unsigned> turno;
+
+    std::shared_ptr<ColaRetiro> retiro;
+    std::thread hiloRetiro;
+
+    RegistroConexiones() : siguienteVersion(1), turno(0), retiro(std::make_shared<ColaRetiro>()) {
+        hiloRetiro = std::thread(&RegistroConexiones::bucleRetiro, retiro);
+    }
+
+    // Los pools en uso que se suelten después se cierran en su propio hilo
+    ~RegistroConexiones() {
+        std::map<std::string, std::shared_ptr<PoolConexiones> > restantes;
+        {
+            std::lock_guard<std::mutex> lock(mutexPools);
+            restantes.swap(pools);
+        }
+        restantes.clear();
+        {
+            std::lock_guard<std::mutex> lock(retiro->mutex);
+            retiro->activa = false;
+        }
+        retiro->hayPools.notify_one();
+        hiloRetiro.join();
+    }
+
+    static void bucleRetiro(std::shared_ptr<ColaRetiro> cola) {
+        std::vector<PoolConexiones*> cerrar;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(cola->mutex);
+                cola->hayPools.wait(lock, [&cola] { return !cola->activa || !cola->pendientes.empty(); });
+                if (cola->pendientes.empty()) return;
+                cerrar.swap(cola->pendientes);
+            }
+            for (size_t i = 0; i < cerrar.size(); i++) delete cerrar[i];
+            cerrar.clear();
+        }
+    }
+
+    // Llamar con mutexPools tomado
+    bool otraPrimaria(const ConfiguracionPool& config) const {
+        if (config.rol != ROL_PRIMARIA) return false;
+        for (std::map<std::string, std::shared_ptr<PoolConexiones> >::const_iterator it = pools.begin();
+             it != pools.end(); ++it) {
+            if (it->first != config.nombre && it->second->getConfiguracion().rol == ROL_PRIMARIA) return true;
+        }
+        return false;
+    }
+
+    RegistroConexiones(const RegistroConexiones&) = delete;
+    RegistroConexiones& operator=(const RegistroConexiones&) = delete;
+
+    static bool esLectura(const std::string& sql) {
+        size_t i = 0;
+        while (i < sql.size() && std::isspace(static_cast<unsigned char>(sql[i]))) i++;
+        const char* select = "SELECT";
+        for (size_t k = 0; k < 6; k++, i++) {
+            if (i >= sql.size() || std::toupper(static_cast<unsigned char>(sql[i])) != select[k]) return false;
+        }
+        return true;
+    }
+
+    std::shared_ptr<PoolConexiones> elegir(bool lectura) {
+        std::lock_guard<std::mutex> lock(mutexPools);
+        if (pools.empty()) return nullptr;
+
+        std::shared_ptr<PoolConexiones> primaria;
+        std::shared_ptr<PoolConexiones> mejor;
+        // El recorrido empieza en una posición rotatoria para repartir empates
+        size_t inicio = turno.fetch_add(1, std::memory_order_relaxed) % pools.size();
+        std::map<std::string, std::shared_ptr<PoolConexiones> >::const_iterator it = pools.begin();
+        std::advance(it, inicio);
+        for (size_t k = 0; k < pools.size(); k++, ++it) {
+            if (it == pools.end()) it = pools.begin();
+            const std::shared_ptr<PoolConexiones>& pool = it->second;
+            if (pool->getConfiguracion().rol == ROL_PRIMARIA) {
+                if (!primaria) primaria = pool;
+            } else if (lectura && (!mejor || pool->getEnCurso() < mejor->getEnCurso())) {
+                mejor = pool;
+            }
+        }
+        return mejor ? mejor : primaria;
+    }
+
+    std::shared_ptr<PoolConexiones> buscar(const std::string& nombre) const {
+        std::lock_guard<std::mutex> lock(mutexPools);
+        std::map<std::string, std::shared_ptr<PoolConexiones> >::const_iterator it = pools.find(nombre);
+        return it != pools.end() ? it->second : nullptr;
+    }
+
+public:
+    static RegistroConexiones* obtenerInstancia() {
+        RegistroConexiones* actual = instancia.load(std::memory_order_acquire);
+        if (actual == nullptr) {
+            std::lock_guard<std::mutex> lock(mutexInstancia);
+            actual = instancia.load(std::memory_order_relaxed);
+            if (actual == nullptr) {
+                actual = new RegistroConexiones();
+                instancia.store(actual, std::memory_order_release);
+            }
+        }
+        return actual;
+    }
+
+    // Crea o reemplaza el pool `config.nombre` sin detener a los demás.
+    // Devuelve false si es una primaria y ya hay otra con distinto nombre.
+    bool configurarPool(const ConfiguracionPool& config) {
+        {
+            std::lock_guard<std::mutex> lock(mutexPools);
+            if (otraPrimaria(config)) {
+                std::cout << "❌ Error: ya hay una primaria; '" << config.nombre << "' no se configura\n";
+                return false;
+            }
+        }
+        unsigned version = siguienteVersion.fetch_add(1);
+        std::cout << "🔧 Conectando pool '" << config.nombre << "' v" << version << " ("
+                  << (config.rol == ROL_PRIMARIA ? "primaria" : "réplica") << ", "
+                  << config.host << ":" << config.puerto << ", "
+                  << config.conexiones << " conexiones)...\n";
+        std::shared_ptr<PoolConexiones> nuevo(new PoolConexiones(config, version), RetirarPool{retiro});
+
+        std::shared_ptr<PoolConexiones> anterior;
+        {
+            std::lock_guard<std::mutex> lock(mutexPools);
+            // Otra primaria pudo publicarse mientras este pool conectaba
+            if (otraPrimaria(config)) {
+                std::cout << "❌ Error: ya hay una primaria; '" << config.nombre << "' no se configura\n";
+                return false;
+            }
+            anterior = pools[config.nombre];
+            pools[config.nombre] = nuevo;
+        }
+        std::cout << "✅ Pool '" << config.nombre << "' v" << version << " activo";
+        if (anterior) {
+            std::cout << " (v" << anterior->getVersion() << " termina sus "
+                      << anterior->getEnCurso() << " consultas en curso)";
+        }
+        std::cout << "\n";
+        return true;
+    }
+
+    bool eliminarPool(const std::string& nombre) {
+        std::shared_ptr<PoolConexiones> anterior;
+        {
+            std::lock_guard<std::mutex> lock(mutexPools);
+            std::map<std::string, std::shared_ptr<PoolConexiones> >::iterator it = pools.find(nombre);
+            if (it == pools.end()) return false;
+            anterior = it->second;
+            pools.erase(it);
+        }
+        // `anterior` se suelta aquí, fuera del lock; el hilo de retiro lo
+        // cierra cuando termine su última consulta en curso
+        return true;
+    }
+
+    // Enruta según el tipo de sentencia
+    std::string ejecutar(const std::string& sql) {
+        std::shared_ptr<PoolConexiones> pool = elegir(esLectura(sql));
+        if (!pool) {
+            std::cout << "❌ Error: No hay ningún pool configurado\n";
+            return "";
+        }
+        return pool->usar([&sql](ConexionBD& c) { return c.ejecutarConsulta(sql); });
+    }
+
+    ResultadoConsulta consultar(const std::string& sql) {
+        std::shared_ptr<PoolConexiones> pool = elegir(esLectura(sql));
+        if (!pool) {
+            std::cout << "❌ Error: No hay ningún pool configurado\n";
+            return ResultadoConsulta();
+        }
+        return pool->usar([&sql](ConexionBD& c) { return c.consultar(sql); });
+    }
+
+    std::string ejecutarEn(const std::string& nombre, const std::string& sql) {
+        std::shared_ptr<PoolConexiones> pool = buscar(nombre);
+        if (!pool) {
+            std::cout << "❌ Error: No existe el pool '" << nombre << "'\n";
+            return "";
+        }
+        return pool->usar([&sql](ConexionBD& c) { return c.ejecutarConsulta(sql); });
+    }
+
+    void imprimirEstado() const {
+        std::lock_guard<std::mutex> lock(mutexPools);
+        std::cout << std::left << std::setw(14) << "Pool" << std::setw(5) << "Ver."
+                  << std::setw(11) << "Rol" << std::setw(18) << "Host"
+                  << std::right << std::setw(10) << "Atendidas" << std::setw(12) << "Pico curso" << "\n";
+        for (std::map<std::string, std::shared_ptr<PoolConexiones> >::const_iterator it = pools.begin();
+             it != pools.end(); ++it) {
+            const PoolConexiones& pool = *it->second;
+            const ConfiguracionPool& c = pool.getConfiguracion();
+            std::cout << std::left << std::setw(14) << c.nombre
+                      << std::setw(5) << ("v" + std::to_string(pool.getVersion()))
+                      << std::setw(c.rol == ROL_PRIMARIA ? 11 : 12)
+                      << (c.rol == ROL_PRIMARIA ? "primaria" : "réplica")
+                      << std::setw(18) << (c.host + ":" + std::to_string(c.puerto))
+                      << std::right << std::setw(10) << pool.getAtendidas()
+                      << std::setw(12) << pool.getPicoEnCurso() << "\n";
+        }
+    }
+
+    static void destruirInstancia() {
+        std::lock_guard<std::mutex> lock(mutexInstancia);
+        RegistroConexiones* actual = instancia.exchange(nullptr);
+        delete actual;
+    }
+};
+
+std::atomic<RegistroConexiones*> RegistroConexiones::instancia(nullptr);
+std::mutex RegistroConexiones::mutexInstancia;
+
+#endif
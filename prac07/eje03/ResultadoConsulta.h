@@ -0,0 +1,237 @@
+#ifndef RESULTADOCONSULTA_H
+#define RESULTADOCONSULTA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+// ---------------------------------------------------------------------------
+// Arena: reserva por desplazamiento dentro de bloques que crecen al doble.
+// No hay liberación individual; todos los bloques se sueltan a la vez al
+// destruir la arena. Solo admite tipos trivialmente destructibles.
+// ---------------------------------------------------------------------------
+class Arena {
+private:
+    static const size_t TAM_BLOQUE_MAXIMO = 1 << 20;
+
+    std::vector<char*> bloques;
+    char* cursor;
+    char* limite;
+    size_t tamSiguienteBloque;
+    size_t bytesReservados;
+
+    void nuevoBloque(size_t minimo) {
+        size_t tam = tamSiguienteBloque > minimo ? tamSiguienteBloque : minimo;
+        char* bloque = static_cast<char*>(::operator new(tam));
+        bloques.push_back(bloque);
+        cursor = bloque;
+        limite = bloque + tam;
+        bytesReservados += tam;
+        if (tamSiguienteBloque < TAM_BLOQUE_MAXIMO) tamSiguienteBloque *= 2;
+    }
+
+    void liberar() {
+        for (size_t i = 0; i < bloques.size(); i++) ::operator delete(bloques[i]);
+        bloques.clear();
+        cursor = limite = nullptr;
+        bytesReservados = 0;
+    }
+
+public:
+    explicit Arena(size_t tamInicial = 4096)
+        : cursor(nullptr), limite(nullptr), tamSiguienteBloque(tamInicial), bytesReservados(0) {}
+
+    Arena(Arena&& otra)
+        : bloques(std::move(otra.bloques)), cursor(otra.cursor), limite(otra.limite),
+          tamSiguienteBloque(otra.tamSiguienteBloque), bytesReservados(otra.bytesReservados) {
+        otra.bloques.clear();
+        otra.cursor = otra.limite = nullptr;
+        otra.bytesReservados = 0;
+    }
+
+    Arena& operator=(Arena&& otra) {
+        if (this != &otra) {
+            liberar();
+            bloques = std::move(otra.bloques);
+            cursor = otra.cursor;
+            limite = otra.limite;
+            tamSiguienteBloque = otra.tamSiguienteBloque;
+            bytesReservados = otra.bytesReservados;
+            otra.bloques.clear();
+            otra.cursor = otra.limite = nullptr;
+            otra.bytesReservados = 0;
+        }
+        return *this;
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() { liberar(); }
+
+    void* reservar(size_t bytes, size_t alineacion = alignof(std::max_align_t)) {
+        uintptr_t p = (reinterpret_cast<uintptr_t>(cursor) + alineacion - 1) & ~(uintptr_t)(alineacion - 1);
+        if (cursor == nullptr || p + bytes > reinterpret_cast<uintptr_t>(limite)) {
+            nuevoBloque(bytes + alineacion);
+            p = (reinterpret_cast<uintptr_t>(cursor) + alineacion - 1) & ~(uintptr_t)(alineacion - 1);
+        }
+        cursor = reinterpret_cast<char*>(p + bytes);
+        return reinterpret_cast<void*>(p);
+    }
+
+    template <typename T>
+    T* crearArreglo(size_t n) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "La arena nunca llama a destructores");
+        T* arreglo = static_cast<T*>(reservar(sizeof(T) * n, alignof(T)));
+        for (size_t i = 0; i < n; i++) new (arreglo + i) T();
+        return arreglo;
+    }
+
+    // Devuelve a la arena la parte no usada de la última reserva
+    void recortar(char* inicioUltimaReserva, size_t usados) {
+        cursor = inicioUltimaReserva + usados;
+    }
+
+    size_t getBytesReservados() const { return bytesReservados; }
+    size_t getNumBloques() const { return bloques.size(); }
+};
+
+// Vista de solo lectura sobre texto que vive en otra parte (la arena).
+// Equivale a std::string_view, que no existe en C++11.
+class VistaTexto {
+private:
+    const char* inicio;
+    size_t tam;
+
+public:
+    VistaTexto() : inicio(nullptr), tam(0) {}
+    VistaTexto(const char* datos, size_t longitud) : inicio(datos), tam(longitud) {}
+
+    const char* datos() const { return inicio; }
+    size_t longitud() const { return tam; }
+    bool vacia() const { return tam == 0; }
+    char operator[](size_t i) const { return inicio[i]; }
+
+    std::string str() const { return std::string(inicio, tam); }
+
+    bool operator==(const char* texto) const {
+        return std::strlen(texto) == tam && std::memcmp(inicio, texto, tam) == 0;
+    }
+
+#if __cplusplus >= 201703L
+    operator std::string_view() const { return std::string_view(inicio, tam); }
+#endif
+};
+
+// Respeta std::setw y std::left como lo haría un std::string
+inline std::ostream& operator<<(std::ostream& os, const VistaTexto& vista) {
+    std::streamsize longitud = static_cast<std::streamsize>(vista.longitud());
+    std::streamsize relleno = os.width() > longitud ? os.width() - longitud : 0;
+    bool izquierda = (os.flags() & std::ios::adjustfield) == std::ios::left;
+    os.width(0);
+    if (!izquierda) for (std::streamsize i = 0; i < relleno; i++) os.put(os.fill());
+    os.write(vista.datos(), longitud);
+    if (izquierda) for (std::streamsize i = 0; i < relleno; i++) os.put(os.fill());
+    return os;
+}
+
+// Una fila del resultado: sus celdas son vistas sobre la arena
+class Fila {
+private:
+    const VistaTexto* celdas;
+    size_t numColumnas;
+
+public:
+    Fila() : celdas(nullptr), numColumnas(0) {}
+    Fila(const VistaTexto* c, size_t n) : celdas(c), numColumnas(n) {}
+
+    const VistaTexto& operator[](size_t columna) const { return celdas[columna]; }
+    size_t getNumColumnas() const { return numColumnas; }
+};
+
+// ---------------------------------------------------------------------------
+// Resultado tabular de una consulta. Nombres de columna, celdas y el resumen
+// se guardan en una arena propia; los llamadores reciben Fila/VistaTexto sin
+// copias y todo se libera de una vez cuando el resultado sale de ámbito.
+// Las vistas no deben sobrevivir al ResultadoConsulta que las creó.
+// ---------------------------------------------------------------------------
+class ResultadoConsulta {
+private:
+    Arena arena;
+    VistaTexto* columnas;
+    size_t numColumnas;
+    std::vector<const VistaTexto*> filas;
+    VistaTexto resumen;
+
+    VistaTexto copiarTexto(const char* texto, size_t longitud) {
+        char* destino = static_cast<char*>(arena.reservar(longitud, 1));
+        std::memcpy(destino, texto, longitud);
+        return VistaTexto(destino, longitud);
+    }
+
+public:
+    ResultadoConsulta() : columnas(nullptr), numColumnas(0) {}
+
+    ResultadoConsulta(ResultadoConsulta&&) = default;
+    ResultadoConsulta& operator=(ResultadoConsulta&&) = default;
+    ResultadoConsulta(const ResultadoConsulta&) = delete;
+    ResultadoConsulta& operator=(const ResultadoConsulta&) = delete;
+
+    // ---- Construcción (la usa quien produce las filas) ----
+    void definirColumnas(const std::vector<std::string>& nombres) {
+        numColumnas = nombres.size();
+        columnas = arena.crearArreglo<VistaTexto>(numColumnas);
+        for (size_t i = 0; i < numColumnas; i++) {
+            columnas[i] = copiarTexto(nombres[i].data(), nombres[i].size());
+        }
+    }
+
+    void reservarFilas(size_t n) { filas.reserve(n); }
+
+    // Celdas vacías de una fila nueva, para rellenar con vistas sobre getArena()
+    VistaTexto* nuevaFila() {
+        VistaTexto* celdas = arena.crearArreglo<VistaTexto>(numColumnas);
+        filas.push_back(celdas);
+        return celdas;
+    }
+
+    void setResumen(const std::string& texto) { resumen = copiarTexto(texto.data(), texto.size()); }
+
+    Arena& getArena() { return arena; }
+
+    // ---- Lectura ----
+    class Iterador {
+    private:
+        const ResultadoConsulta* resultado;
+        size_t indice;
+    public:
+        Iterador(const ResultadoConsulta* r, size_t i) : resultado(r), indice(i) {}
+        Fila operator*() const { return resultado->getFila(indice); }
+        Iterador& operator++() { indice++; return *this; }
+        bool operator!=(const Iterador& otro) const { return indice != otro.indice; }
+    };
+
+    Iterador begin() const { return Iterador(this, 0); }
+    Iterador end() const { return Iterador(this, filas.size()); }
+
+    Fila getFila(size_t i) const { return Fila(filas[i], numColumnas); }
+    VistaTexto getColumna(size_t i) const { return columnas[i]; }
+    size_t getNumFilas() const { return filas.size(); }
+    size_t getNumColumnas() const { return numColumnas; }
+    bool vacio() const { return filas.empty(); }
+    VistaTexto getResumen() const { return resumen; }
+    size_t getBytesArena() const { return arena.getBytesReservados(); }
+    size_t getNumBloques() const { return arena.getNumBloques(); }
+};
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef TABLASIMULADA_H
+#define TABLASIMULADA_H
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "ResultadoConsulta.h"
+
+// Datos deterministas para las consultas simuladas. La tabla sale de
+// "FROM <tabla>" y el número de filas de "LIMIT <n>" (5 si no se indica).
+class TablaSimulada {
+private:
+    std::string nombre;
+    std::vector<std::string> columnas;
+    long numFilas;
+
+    static std::string palabraTras(const std::string& sql, const std::string& clave) {
+        size_t pos = sql.find(clave);
+        if (pos == std::string::npos) return "";
+        pos += clave.size();
+        size_t fin = pos;
+        while (fin < sql.size() && (std::isalnum(static_cast<unsigned char>(sql[fin])) || sql[fin] == '_')) fin++;
+        return sql.substr(pos, fin - pos);
+    }
+
+public:
+    static const size_t MAX_CELDA = 64;
+
+    static TablaSimulada desdeConsulta(const std::string& sql) {
+        TablaSimulada tabla;
+        tabla.nombre = palabraTras(sql, "FROM ");
+        if (tabla.nombre.empty()) tabla.nombre = "tabla";
+
+        std::string limite = palabraTras(sql, "LIMIT ");
+        tabla.numFilas = limite.empty() ? 5 : std::atol(limite.c_str());
+
+        if (tabla.nombre == "usuarios") {
+            tabla.columnas = {"id", "nombre", "email"};
+        } else if (tabla.nombre == "productos") {
+            tabla.columnas = {"id", "nombre", "precio"};
+        } else {
+            tabla.columnas = {"id", "valor"};
+        }
+        return tabla;
+    }
+
+    const std::string& getNombre() const { return nombre; }
+    const std::vector<std::string>& getColumnas() const { return columnas; }
+    long getNumFilas() const { return numFilas; }
+
+    // Escribe la celda en `destino` (al menos MAX_CELDA bytes) y devuelve su longitud
+    size_t escribirCelda(long fila, size_t columna, char* destino) const {
+        const std::string& col = columnas[columna];
+        long id = fila + 1;
+        int n;
+        if (col == "id") {
+            n = std::snprintf(destino, MAX_CELDA, "%ld", id);
+        } else if (col == "email") {
+            n = std::snprintf(destino, MAX_CELDA, "usuario_%ld@ejemplo.com", id);
+        } else if (col == "precio") {
+            n = std::snprintf(destino, MAX_CELDA, "%ld.%02ld", (id * 37) % 1000, (id * 13) % 100);
+        } else if (col == "nombre") {
+            n = std::snprintf(destino, MAX_CELDA, "%s_%ld", nombre.c_str(), id);
+        } else {
+            n = std::snprintf(destino, MAX_CELDA, "%s_%ld", col.c_str(), id);
+        }
+        return n < 0 ? 0 : (static_cast<size_t>(n) < MAX_CELDA ? static_cast<size_t>(n) : MAX_CELDA - 1);
+    }
+
+    // Añade las filas [desde, hasta) al resultado, escribiendo cada celda
+    // directamente en su arena
+    void llenar(ResultadoConsulta& resultado, long desde, long hasta) const {
+        if (resultado.getNumColumnas() == 0) resultado.definirColumnas(columnas);
+        if (hasta > numFilas) hasta = numFilas;
+        if (hasta > desde) resultado.reservarFilas(resultado.getNumFilas() + (hasta - desde));
+
+        Arena& arena = resultado.getArena();
+        for (long fila = desde; fila < hasta; fila++) {
+            VistaTexto* celdas = resultado.nuevaFila();
+            for (size_t c = 0; c < columnas.size(); c++) {
+                char* destino = static_cast<char*>(arena.reservar(MAX_CELDA, 1));
+                size_t longitud = escribirCelda(fila, c, destino);
+                arena.recortar(destino, longitud);
+                celdas[c] = VistaTexto(destino, longitud);
+            }
+        }
+    }
+};
+
+#endif
@@ -1,5 +1,15 @@
 #include "ConexionBD.h"
+#include "RegistroConexiones.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iomanip>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 class RepositorioUsuarios {
 private:
@@ -11,6 +21,16 @@ public:
         std::cout << "\n--- RepositorioUsuarios: Obteniendo usuarios ---\n";
         conexion->ejecutarConsulta("SELECT * FROM usuarios");
     }
+    
+    std::string obtenerUsuario(int id) {
+        return conexion->ejecutarConsulta("SELECT * FROM usuarios WHERE id = " + std::to_string(id));
+    }
+    
+#if defined(__cpp_impl_coroutine)
+    Tarea<std::string> obtenerUsuarioAsync(int id) {
+        co_return co_await conexion->consulta("SELECT * FROM usuarios WHERE id = " + std::to_string(id));
+    }
+#endif
 };
 
 class RepositorioProductos {
@@ -23,8 +43,297 @@ public:
         std::cout << "\n--- RepositorioProductos: Obteniendo productos ---\n";
         conexion->ejecutarConsulta("SELECT * FROM productos");
     }
+    
+    std::string obtenerProductosDe(int idUsuario) {
+        return conexion->ejecutarConsulta("SELECT * FROM productos WHERE vendedor = " +
+                                          std::to_string(idUsuario));
+    }
+    
+#if defined(__cpp_impl_coroutine)
+    Tarea<std::string> obtenerProductosDeAsync(int idUsuario) {
+        co_return co_await conexion->consulta("SELECT * FROM productos WHERE vendedor = " +
+                                              std::to_string(idUsuario));
+    }
+#endif
+};
+
+// Memoria del proceso según /proc/self/status (en KB)
+struct MedidaMemoria {
+    long residenteKB;
+    long virtualKB;
 };
 
+MedidaMemoria medirMemoria() {
+    MedidaMemoria medida = {0, 0};
+    std::ifstream estado("/proc/self/status");
+    std::string clave;
+    while (estado >> clave) {
+        if (clave == "VmRSS:") estado >> medida.residenteKB;
+        else if (clave == "VmSize:") estado >> medida.virtualKB;
+    }
+    return medida;
+}
+
+double segundosDesde(std::chrono::steady_clock::time_point inicio) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+// Recorre 200000 filas en lotes de 10000, simulando 20 ms de proceso por lote
+void exportarConCursor(ConexionBD* conexion, size_t lotesPrefetch) {
+    EntornoLatencia* entorno = EntornoLatencia::obtenerInstancia();
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+    
+    std::unique_ptr<CursorConsulta> cursor =
+        conexion->abrirCursor("SELECT * FROM productos LIMIT 200000", 10000, lotesPrefetch);
+    long filas = 0;
+    size_t bytesPrecios = 0;
+    while (const ResultadoConsulta* lote = cursor->siguienteLote()) {
+        for (Fila fila : *lote) {
+            bytesPrecios += fila[2].longitud();
+            filas++;
+        }
+        // Más lento que traer un lote (20 ms): la cola llega a llenarse
+        entorno->pausa(std::chrono::milliseconds(30));
+    }
+    double segundos = segundosDesde(inicio);
+    
+    std::cout << (lotesPrefetch > 0 ? "⏩ Con prefetch de " : "⏸️  Sin prefetch")
+              << (lotesPrefetch > 0 ? std::to_string(lotesPrefetch) + " lotes" : "") << ": "
+              << filas << " filas en " << cursor->getLotesLeidos() << " lotes, "
+              << std::fixed << std::setprecision(3) << segundos << " s\n";
+    std::cout << "   Pico en memoria: " << cursor->getPicoBytesEnMemoria() / 1024 << " KB, lote en curso incluido ("
+              << cursor->getPicoLotesEnCola() << " lotes en cola como máximo, "
+              << bytesPrecios << " bytes de precios)\n";
+}
+
+// Lanza lecturas protegidas cada 10 ms y resume cómo terminaron
+void ejecutarFase(ConexionBD* conexion, const std::string& nombre, int consultas) {
+    Reloj& reloj = EntornoLatencia::obtenerInstancia()->getReloj();
+    int porEstado[CONSULTA_SIN_CONEXION + 1] = {0};
+    int cubiertas = 0;
+    std::vector<int64_t> latencias;
+    
+    for (int i = 0; i < consultas; i++) {
+        RespuestaConsulta respuesta = conexion->ejecutarConsultaProtegida(
+            "SELECT * FROM usuarios WHERE id = " + std::to_string(i), OpcionesConsulta::lectura());
+        porEstado[respuesta.estado]++;
+        if (respuesta.cubierta) cubiertas++;
+        if (respuesta.estado != CONSULTA_RECHAZADA) latencias.push_back(respuesta.latencia.count());
+        reloj.esperar(std::chrono::milliseconds(10));
+    }
+    
+    std::sort(latencias.begin(), latencias.end());
+    double p50 = latencias.empty() ? 0 : latencias[latencias.size() / 2] / 1e6;
+    double p99 = latencias.empty() ? 0 : latencias[(latencias.size() - 1) * 99 / 100] / 1e6;
+    std::cout << std::left << std::setw(12) << nombre << std::right
+              << std::setw(5) << porEstado[CONSULTA_OK]
+              << std::setw(9) << porEstado[CONSULTA_TIMEOUT]
+              << std::setw(7) << porEstado[CONSULTA_ERROR]
+              << std::setw(11) << porEstado[CONSULTA_RECHAZADA]
+              << std::setw(11) << cubiertas
+              << std::fixed << std::setprecision(1)
+              << std::setw(9) << p50 << std::setw(9) << p99
+              << std::setw(10) << conexion->getTimeoutAdaptativo().count() / 1e6
+              << "  " << nombreEstadoCircuito(conexion->getEstadoCircuito()) << "\n";
+}
+
+// Backend sano, degradado (lento y con 50 % de errores) y recuperado, sobre
+// el reloj virtual para no esperar de verdad
+void demoProteccion(ConexionBD* conexion) {
+    EntornoLatencia* entorno = EntornoLatencia::obtenerInstancia();
+    bool eraVirtual = entorno->usaRelojVirtual();
+    entorno->usarRelojVirtual();
+    conexion->setSilencioso(true);
+    
+    std::cout << std::left << std::setw(12) << "Fase" << std::right << std::setw(5) << "OK"
+              << std::setw(9) << "Timeout" << std::setw(7) << "Error" << std::setw(11) << "Rechazada"
+              << std::setw(11) << "Cubiertas" << std::setw(9) << "p50 ms" << std::setw(9) << "p99 ms"
+              << std::setw(10) << "Plazo ms" << "  Circuito\n";
+    
+    conexion->setLatenciaConsulta(ModeloLatencia::crear("lognormal:20:0.6"));
+    conexion->setProbabilidadError(0.01);
+    ejecutarFase(conexion, "Sano", 200);
+    
+    conexion->setLatenciaConsulta(ModeloLatencia::crear("lognormal:400:1.0"));
+    conexion->setProbabilidadError(0.5);
+    ejecutarFase(conexion, "Degradado", 100);
+    
+    conexion->setLatenciaConsulta(ModeloLatencia::crear("lognormal:20:0.6"));
+    conexion->setProbabilidadError(0.01);
+    entorno->getReloj().esperar(std::chrono::seconds(2));
+    ejecutarFase(conexion, "Recuperado", 200);
+    
+    std::cout << "\n🔁 Aperturas del cortacircuitos: " << conexion->getAperturasCircuito() << "\n";
+    
+    conexion->setLatenciaConsulta(entorno->modeloPara("CONSULTA", "fija:300"));
+    conexion->setProbabilidadError(0.0);
+    conexion->setSilencioso(false);
+    if (!eraVirtual) entorno->usarRelojReal();
+}
+
+// Lecturas y escrituras concurrentes sobre el registro; a mitad de la carga
+// la réplica lenta se reconfigura hacia otro host sin parar a los demás
+void demoRegistroConexiones() {
+    RegistroConexiones* registro = RegistroConexiones::obtenerInstancia();
+    ConfiguracionPool primaria = {"primaria", ROL_PRIMARIA, "db-primaria", 5432, "mi_aplicacion",
+                                  "admin", 2, "fija:80", "fija:100"};
+    ConfiguracionPool replicaA = {"replica_a", ROL_REPLICA, "db-replica-a", 5432, "mi_aplicacion",
+                                  "lector", 3, "fija:20", "fija:100"};
+    ConfiguracionPool replicaB = {"replica_b", ROL_REPLICA, "db-replica-b", 5432, "mi_aplicacion",
+                                  "lector", 3, "fija:120", "fija:100"};
+    registro->configurarPool(primaria);
+    registro->configurarPool(replicaA);
+    registro->configurarPool(replicaB);
+    // Las escrituras no pueden repartirse entre dos bases: se rechaza
+    ConfiguracionPool otraPrimaria = primaria;
+    otraPrimaria.nombre = "primaria_2";
+    otraPrimaria.host = "db-primaria-2";
+    registro->configurarPool(otraPrimaria);
+    
+    std::vector<std::thread> clientes;
+    for (int i = 0; i < 8; i++) {
+        clientes.emplace_back([registro, i] {
+            for (int k = 0; k < 10; k++) {
+                registro->ejecutar("SELECT * FROM usuarios WHERE id = " + std::to_string(i * 10 + k));
+            }
+        });
+    }
+    clientes.emplace_back([registro] {
+        for (int k = 0; k < 5; k++) {
+            registro->ejecutar("INSERT INTO logs VALUES ('evento " + std::to_string(k) + "')");
+        }
+    });
+    
+    EntornoLatencia::obtenerInstancia()->pausa(std::chrono::milliseconds(150));
+    ConfiguracionPool replicaB2 = replicaB;
+    replicaB2.host = "db-replica-b2";
+    replicaB2.latenciaConsulta = "fija:20";
+    registro->configurarPool(replicaB2);
+    
+    for (auto& cliente : clientes) cliente.join();
+    
+    std::cout << "\n📊 Estado del registro:\n";
+    registro->imprimirEstado();
+    RegistroConexiones::destruirInstancia();
+}
+
+// Un hilo del sistema por petición: cada consulta bloquea su hilo
+void atenderConHilos(int peticiones) {
+    RepositorioUsuarios repoUsuarios;
+    RepositorioProductos repoProductos;
+    std::atomic<int> completadas(0);
+    
+    MedidaMemoria antes = medirMemoria();
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+    
+    std::vector<std::thread> hilos;
+    for (int i = 0; i < peticiones; i++) {
+        hilos.emplace_back([&repoUsuarios, &repoProductos, &completadas, i] {
+            std::string usuario = repoUsuarios.obtenerUsuario(i);
+            std::string productos = repoProductos.obtenerProductosDe(i);
+            if (!usuario.empty() && !productos.empty()) completadas++;
+        });
+    }
+    MedidaMemoria enVuelo = medirMemoria();
+    for (auto& hilo : hilos) hilo.join();
+    double segundos = segundosDesde(inicio);
+    
+    std::cout << "\n🧵 Hilo por petición (" << peticiones << " hilos)\n";
+    std::cout << "   Peticiones completadas: " << completadas << "\n";
+    std::cout << "   Tiempo: " << std::fixed << std::setprecision(3) << segundos << " s, "
+              << std::setprecision(0) << (2 * peticiones / segundos) << " consultas/s\n";
+    // Lo comparable con las corrutinas es la memoria residente; las pilas
+    // reservadas son espacio de direcciones, casi todo sin tocar
+    long residenteKB = enVuelo.residenteKB - antes.residenteKB;
+    std::cout << "   Memoria residente con todo en vuelo: +" << residenteKB << " KB ("
+              << residenteKB * 1024 / peticiones << " bytes/petición)\n";
+    std::cout << "   Espacio de direcciones reservado (pilas, no memoria usada): +"
+              << (enVuelo.virtualKB - antes.virtualKB) << " KB ("
+              << (enVuelo.virtualKB - antes.virtualKB) / peticiones << " KB/hilo)\n";
+}
+
+#if defined(__cpp_impl_coroutine)
+Tarea<void> atenderPeticion(RepositorioUsuarios& repoUsuarios, RepositorioProductos& repoProductos,
+                            int id, int& completadas) {
+    std::string usuario = co_await repoUsuarios.obtenerUsuarioAsync(id);
+    std::string productos = co_await repoProductos.obtenerProductosDeAsync(id);
+    if (!usuario.empty() && !productos.empty()) completadas++;
+}
+
+// Todas las peticiones como corrutinas sobre el hilo principal
+void atenderConCorrutinas(int peticiones) {
+    RepositorioUsuarios repoUsuarios;
+    RepositorioProductos repoProductos;
+    PlanificadorCorrutinas* planificador = PlanificadorCorrutinas::obtenerInstancia();
+    int completadas = 0;
+    
+    std::size_t bytesAntes = EstadisticasMarcos::bytesVivos;
+    EstadisticasMarcos::bytesPico = bytesAntes;
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+    
+    for (int i = 0; i < peticiones; i++) {
+        planificador->lanzar(atenderPeticion(repoUsuarios, repoProductos, i, completadas));
+    }
+    planificador->ejecutar();
+    double segundos = segundosDesde(inicio);
+    std::size_t bytesMarcos = EstadisticasMarcos::bytesPico - bytesAntes;
+    
+    std::cout << "\n🔁 Corrutinas en 1 hilo (" << planificador->getPicoEnVuelo() << " en vuelo a la vez)\n";
+    std::cout << "   Peticiones completadas: " << completadas << "\n";
+    std::cout << "   Tiempo: " << std::fixed << std::setprecision(3) << segundos << " s, "
+              << std::setprecision(0) << (2 * peticiones / segundos) << " consultas/s\n";
+    // Los marcos se cuentan al reservarlos: es la memoria usada, sin depender
+    // de si malloc la saca de páginas que las demos anteriores dejaron residentes
+    std::cout << "   Memoria de marcos con todo en vuelo: " << bytesMarcos / 1024 << " KB ("
+              << bytesMarcos / peticiones << " bytes/petición)\n";
+}
+#endif
+
+// Escrituras concurrentes con el futuro de cada una; después se cierra el
+// diario y se reconstruye el almacén reproduciéndolo, como tras una caída
+void demoDiario(ConexionBD* conexion) {
+    const int hilos = 8;
+    const int porHilo = 250;
+    const DiarioEscrituras* diario = conexion->getDiario();
+    uint64_t sincronizacionesAntes = diario->getSincronizaciones();
+    
+    conexion->setSilencioso(true);
+    std::atomic<int> confirmadas(0);
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+    std::vector<std::thread> escritores;
+    for (int h = 0; h < hilos; h++) {
+        escritores.emplace_back([conexion, h, &confirmadas] {
+            std::vector<std::future<uint64_t> > futuros;
+            for (int k = 0; k < porHilo; k++) {
+                futuros.push_back(conexion->escribir("INSERT INTO logs VALUES ('hilo " + std::to_string(h) +
+                                                     " evento " + std::to_string(k) + "')"));
+            }
+            for (size_t k = 0; k < futuros.size(); k++) {
+                futuros[k].get();
+                confirmadas++;
+            }
+        });
+    }
+    for (auto& escritor : escritores) escritor.join();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+    conexion->setSilencioso(false);
+    
+    uint64_t sincronizaciones = diario->getSincronizaciones() - sincronizacionesAntes;
+    std::cout << "\n📝 " << confirmadas.load() << " escrituras de " << hilos << " hilos confirmadas en "
+              << std::fixed << std::setprecision(1) << ms << " ms con " << sincronizaciones
+              << " fdatasync (grupo máximo: " << diario->getGrupoMaximo() << ", "
+              << std::setprecision(0) << confirmadas.load() / (ms / 1000.0) << " escrituras/s)\n";
+    std::cout.unsetf(std::ios::fixed);
+    
+    size_t filas = conexion->contarFilas("logs");
+    std::string ruta = diario->getRuta();
+    conexion->cerrarAlmacen();
+    conexion->abrirAlmacen(ruta);
+    std::cout << "🔁 Almacén reconstruido desde el diario: " << conexion->getEscriturasRecuperadas()
+              << " escrituras, " << conexion->contarFilas("logs") << " filas en logs (antes: " << filas << ") "
+              << (conexion->contarFilas("logs") == filas ? "✅" : "❌") << "\n";
+}
+
 int main() {
     std::cout << std::string(60, '=') << "\n";
     std::cout << "EJERCICIO 03: CONEXIÓN BD CON SINGLETON\n";
@@ -55,8 +364,55 @@ int main() {
     
     conexion2->ejecutarConsulta("SELECT * FROM usuarios WHERE id = 1");
     conexion3->ejecutarConsulta("SELECT COUNT(*) FROM productos");
+    // Las escrituras van al almacén local a través de su diario
+    std::remove("conexionbd.diario");
+    conexion1->abrirAlmacen("conexionbd.diario");
     conexion1->ejecutarConsulta("INSERT INTO logs VALUES ('Nueva entrada')");
     
+    std::cout << "\n" << std::string(60, '=') << "\n";
+    std::cout << "RESULTADOS SIN COPIAS (ARENA POR CONSULTA)\n";
+    std::cout << std::string(60, '=') << "\n";
+    
+    {
+        ResultadoConsulta usuarios = conexion1->consultar("SELECT * FROM usuarios LIMIT 3");
+        for (size_t c = 0; c < usuarios.getNumColumnas(); c++) {
+            std::cout << std::left << std::setw(c == 2 ? 24 : 12) << usuarios.getColumna(c) << " ";
+        }
+        std::cout << "\n";
+        for (Fila fila : usuarios) {
+            for (size_t c = 0; c < fila.getNumColumnas(); c++) {
+                std::cout << std::left << std::setw(c == 2 ? 24 : 12) << fila[c] << " ";
+            }
+            std::cout << "\n";
+        }
+        std::cout << std::right;
+        
+        conexion1->setSilencioso(true);
+        ResultadoConsulta productos = conexion1->consultar("SELECT * FROM productos LIMIT 100000");
+        conexion1->setSilencioso(false);
+        size_t bytesPrecios = 0;
+        for (Fila fila : productos) bytesPrecios += fila[2].longitud();
+        std::cout << "\n📦 " << productos.getResumen() << ": " << productos.getNumFilas()
+                  << " filas en " << productos.getBytesArena() / 1024 << " KB de arena ("
+                  << productos.getNumBloques() << " bloques, " << bytesPrecios
+                  << " bytes de precios recorridos sin copiar)\n";
+    }
+    std::cout << "🧹 Arenas liberadas de una vez al salir de ámbito\n";
+    
+    std::cout << "\n" << std::string(60, '=') << "\n";
+    std::cout << "EXPORTACIÓN CON CURSOR POR LOTES\n";
+    std::cout << std::string(60, '=') << "\n";
+    
+    exportarConCursor(conexion1, 0);
+    exportarConCursor(conexion1, 2);
+    exportarConCursor(conexion1, 4);
+    
+    std::cout << "\n" << std::string(60, '=') << "\n";
+    std::cout << "PROTECCIÓN ANTE UN BACKEND LENTO\n";
+    std::cout << std::string(60, '=') << "\n";
+    
+    demoProteccion(conexion1);
+    
     std::cout << "\n" << std::string(60, '=') << "\n";
     std::cout << "ACCESO DESDE DIFERENTES MÓDULOS\n";
     std::cout << std::string(60, '=') << "\n";
@@ -75,6 +431,34 @@ int main() {
     
     conexion2->ejecutarConsulta("SELECT * FROM test");
     
+    std::cout << "\n" << std::string(60, '=') << "\n";
+    std::cout << "PETICIONES CONCURRENTES: HILOS VS CORRUTINAS\n";
+    std::cout << std::string(60, '=') << "\n";
+    
+    const int peticiones = 1000;
+    conexion1->conectar();
+    conexion1->setSilencioso(true);
+    atenderConHilos(peticiones);
+#if defined(__cpp_impl_coroutine)
+    atenderConCorrutinas(peticiones);
+#else
+    std::cout << "\nℹ️  Compila con 'make eje03-corrutinas' (C++20) para comparar con corrutinas\n";
+#endif
+    conexion1->setSilencioso(false);
+    
+    std::cout << "\n" << std::string(60, '=') << "\n";
+    std::cout << "ESCRITURAS CON DIARIO Y CONFIRMACIÓN EN GRUPO\n";
+    std::cout << std::string(60, '=') << "\n";
+    
+    demoDiario(conexion1);
+    conexion1->desconectar();
+    
+    std::cout << "\n" << std::string(60, '=') << "\n";
+    std::cout << "REGISTRO DE CONEXIONES: PRIMARIA + RÉPLICAS\n";
+    std::cout << std::string(60, '=') << "\n";
+    
+    demoRegistroConexiones();
+    
     std::cout << "\n" << std::string(60, '=') << "\n";
     std::cout << "CONCLUSIÓN\n";
     std::cout << std::string(60, '=') << "\n";
@@ -83,5 +467,11 @@ int main() {
     std::cout << "✅ Todos los módulos comparten el mismo estado de conexión\n";
     
     ConexionBD::destruirInstancia();
+#if defined(__cpp_impl_coroutine)
+    PlanificadorCorrutinas::destruirInstancia();
+#endif
+    EntornoLatencia::destruirInstancia();
+    Rastreador::destruirInstancia();
+    RegistroMetricas::destruirInstancia();
     return 0;
 }
@@ -3,8 +3,15 @@
 
 #include <iostream>
 #include <string>
+#include "GeneradorAleatorio.h"
+#include "Instantanea.h"
+#include "DiarioEventos.h"
+#include "TablaRecords.h"
+#include "../comun/Metricas.h"
 
 class ControlJuego {
+    friend class FragmentoSesiones;
+
 private:
     static ControlJuego* instancia;
     int nivelActual;
@@ -14,13 +21,74 @@ private:
     bool juegoEnCurso;
     int enemigosEliminados;
     int itemsRecolectados;
+    GeneradorAleatorio generador;
+    DiarioEventos* diario;
+    TablaRecords* tablaRecords;
+    std::string jugadorActual;
+    bool silencioso;
+    bool reproduciendo;   // los eventos reproducidos no cuentan en las métricas
     
     ControlJuego() : nivelActual(1), puntaje(0), vidas(3), 
                      puntuacionMaxima(0), juegoEnCurso(false),
-                     enemigosEliminados(0), itemsRecolectados(0) {}
+                     enemigosEliminados(0), itemsRecolectados(0),
+                     diario(nullptr), tablaRecords(nullptr),
+                     jugadorActual("Anónimo"), silencioso(false), reproduciendo(false) {}
     
     ControlJuego(const ControlJuego&) = delete;
     ControlJuego& operator=(const ControlJuego&) = delete;
+    
+    // En modo silencioso los mensajes van a un flujo sin buffer, que los
+    // descarta sin formatear; así la reproducción no queda limitada por la consola.
+    std::ostream& salida() const {
+        static thread_local std::ostream flujoNulo(nullptr);
+        return silencioso ? flujoNulo : std::cout;
+    }
+    
+    // Compartidas por todas las partidas (sesiones incluidas)
+    struct MetricasJuego {
+        Contador partidas;
+        Contador enemigos;
+        Contador items;
+        
+        MetricasJuego()
+            : partidas("prac07_juego_partidas_total", "Partidas iniciadas"),
+              enemigos("prac07_juego_enemigos_eliminados_total", "Enemigos eliminados"),
+              items("prac07_juego_items_recolectados_total", "Items recolectados") {}
+    };
+    
+    static const MetricasJuego& metricas() {
+        static const MetricasJuego m;
+        return m;
+    }
+    
+    void registrar(TipoEvento tipo, int valor = 0) {
+        if (diario != nullptr) diario->registrar(tipo, valor);
+    }
+    
+    void cerrarPartida() {
+        salida() << "\n" << std::string(60, '=') << "\n";
+        salida() << "🏁 JUEGO FINALIZADO\n";
+        salida() << std::string(60, '=') << "\n";
+        
+        if (puntaje > puntuacionMaxima) {
+            puntuacionMaxima = puntaje;
+            salida() << "🏆 ¡NUEVO RÉCORD!\n";
+        }
+        
+        if (tablaRecords != nullptr &&
+            tablaRecords->registrar(jugadorActual, puntaje, nivelActual)) {
+            salida() << "📋 " << jugadorActual << " entra en la tabla de récords\n";
+        }
+        
+        salida() << "Puntaje final: " << puntaje << "\n";
+        salida() << "Nivel alcanzado: " << nivelActual << "\n";
+        salida() << "Enemigos eliminados: " << enemigosEliminados << "\n";
+        salida() << "Items recolectados: " << itemsRecolectados << "\n";
+        salida() << "Récord: " << puntuacionMaxima << "\n";
+        salida() << std::string(60, '=') << "\n";
+        
+        juegoEnCurso = false;
+    }
 
 public:
     static ControlJuego* obtenerInstancia() {
@@ -34,78 +102,68 @@ public:
     
     bool iniciarJuego() {
         if (juegoEnCurso) {
-            std::cout << "⚠️  Ya hay un juego en curso\n";
+            salida() << "⚠️  Ya hay un juego en curso\n";
             return false;
         }
         
-        std::cout << "\n" << std::string(60, '=') << "\n";
-        std::cout << "🎮 INICIANDO NUEVO JUEGO\n";
-        std::cout << std::string(60, '=') << "\n";
+        salida() << "\n" << std::string(60, '=') << "\n";
+        salida() << "🎮 INICIANDO NUEVO JUEGO\n";
+        salida() << std::string(60, '=') << "\n";
+        registrar(EVENTO_INICIAR);
         nivelActual = 1;
         puntaje = 0;
         vidas = 3;
         enemigosEliminados = 0;
         itemsRecolectados = 0;
         juegoEnCurso = true;
+        if (!reproduciendo) metricas().partidas.incrementar();
         mostrarEstado();
         return true;
     }
     
     bool finalizarJuego() {
         if (!juegoEnCurso) {
-            std::cout << "⚠️  No hay juego en curso\n";
+            salida() << "⚠️  No hay juego en curso\n";
             return false;
         }
         
-        std::cout << "\n" << std::string(60, '=') << "\n";
-        std::cout << "🏁 JUEGO FINALIZADO\n";
-        std::cout << std::string(60, '=') << "\n";
-        
-        if (puntaje > puntuacionMaxima) {
-            puntuacionMaxima = puntaje;
-            std::cout << "🏆 ¡NUEVO RÉCORD!\n";
-        }
-        
-        std::cout << "Puntaje final: " << puntaje << "\n";
-        std::cout << "Nivel alcanzado: " << nivelActual << "\n";
-        std::cout << "Enemigos eliminados: " << enemigosEliminados << "\n";
-        std::cout << "Items recolectados: " << itemsRecolectados << "\n";
-        std::cout << "Récord: " << puntuacionMaxima << "\n";
-        std::cout << std::string(60, '=') << "\n";
-        
-        juegoEnCurso = false;
+        registrar(EVENTO_FINALIZAR);
+        cerrarPartida();
         return true;
     }
     
     bool subirNivel() {
         if (!juegoEnCurso) {
-            std::cout << "❌ No hay juego en curso\n";
+            salida() << "❌ No hay juego en curso\n";
             return false;
         }
         
+        registrar(EVENTO_SUBIR_NIVEL);
         nivelActual++;
         int bonus = nivelActual * 100;
         puntaje += bonus;
-        std::cout << "\n🎉 ¡NIVEL " << nivelActual << " COMPLETADO!\n";
-        std::cout << "   Bonus de nivel: +" << bonus << " puntos\n";
+        salida() << "\n🎉 ¡NIVEL " << nivelActual << " COMPLETADO!\n";
+        salida() << "   Bonus de nivel: +" << bonus << " puntos\n";
         return true;
     }
     
     bool sumarPuntos(int puntos) {
         if (!juegoEnCurso) return false;
+        registrar(EVENTO_SUMAR_PUNTOS, puntos);
         puntaje += puntos;
-        std::cout << "   ✨ +" << puntos << " puntos (Total: " << puntaje << ")\n";
+        salida() << "   ✨ +" << puntos << " puntos (Total: " << puntaje << ")\n";
         return true;
     }
     
     bool perderVida() {
         if (!juegoEnCurso) return false;
+        registrar(EVENTO_PERDER_VIDA);
         vidas--;
-        std::cout << "   💔 Perdiste una vida (Vidas restantes: " << vidas << ")\n";
+        salida() << "   💔 Perdiste una vida (Vidas restantes: " << vidas << ")\n";
         
         if (vidas <= 0) {
-            std::cout << "   ☠️  GAME OVER - Sin vidas restantes\n";
-            finalizarJuego();
+            salida() << "   ☠️  GAME OVER - Sin vidas restantes\n";
+            cerrarPartida();
             return false;
         }
         return true;
@@ -113,33 +171,40 @@ public:
     
     bool ganarVida() {
         if (!juegoEnCurso) return false;
+        registrar(EVENTO_GANAR_VIDA);
         vidas++;
-        std::cout << "   💚 ¡Ganaste una vida! (Vidas: " << vidas << ")\n";
+        salida() << "   💚 ¡Ganaste una vida! (Vidas: " << vidas << ")\n";
         return true;
     }
     
     void registrarEnemigoEliminado() {
-        if (juegoEnCurso) enemigosEliminados++;
+        if (!juegoEnCurso) return;
+        registrar(EVENTO_ENEMIGO_ELIMINADO);
+        enemigosEliminados++;
+        if (!reproduciendo) metricas().enemigos.incrementar();
     }
     
     void registrarItemRecolectado() {
-        if (juegoEnCurso) itemsRecolectados++;
+        if (!juegoEnCurso) return;
+        registrar(EVENTO_ITEM_RECOLECTADO);
+        itemsRecolectados++;
+        if (!reproduciendo) metricas().items.incrementar();
     }
     
     void mostrarEstado() const {
-        std::cout << "\n" << std::string(60, '=') << "\n";
-        std::cout << "📊 ESTADO DEL JUEGO\n";
-        std::cout << std::string(60, '=') << "\n";
-        std::cout << "Estado: " << (juegoEnCurso ? "🟢 EN CURSO" : "🔴 DETENIDO") << "\n";
-        std::cout << "Nivel: " << nivelActual << "\n";
-        std::cout << "Puntaje: " << puntaje << "\n";
-        std::cout << "Vidas: ";
-        for (int i = 0; i < vidas; i++) std::cout << "❤️ ";
-        std::cout << "\n";
-        std::cout << "Enemigos eliminados: " << enemigosEliminados << "\n";
-        std::cout << "Items recolectados: " << itemsRecolectados << "\n";
-        std::cout << "Récord histórico: " << puntuacionMaxima << "\n";
-        std::cout << std::string(60, '=') << "\n";
+        salida() << "\n" << std::string(60, '=') << "\n";
+        salida() << "📊 ESTADO DEL JUEGO\n";
+        salida() << std::string(60, '=') << "\n";
+        salida() << "Estado: " << (juegoEnCurso ? "🟢 EN CURSO" : "🔴 DETENIDO") << "\n";
+        salida() << "Nivel: " << nivelActual << "\n";
+        salida() << "Puntaje: " << puntaje << "\n";
+        salida() << "Vidas: ";
+        for (int i = 0; i < vidas; i++) salida() << "❤️ ";
+        salida() << "\n";
+        salida() << "Enemigos eliminados: " << enemigosEliminados << "\n";
+        salida() << "Items recolectados: " << itemsRecolectados << "\n";
+        salida() << "Récord histórico: " << puntuacionMaxima << "\n";
+        salida() << std::string(60, '=') << "\n";
     }
     
     int getNivel() const { return nivelActual; }
@@ -147,6 +212,131 @@ public:
     int getVidas() const { return vidas; }
     bool estaEnCurso() const { return juegoEnCurso; }
     
+    // ---- Tabla de récords persistente ----
+    void conectarTablaRecords(TablaRecords* tabla) {
+        tablaRecords = tabla;
+        if (tablaRecords != nullptr && tablaRecords->recordHistorico() > puntuacionMaxima) {
+            puntuacionMaxima = tablaRecords->recordHistorico();
+        }
+    }
+    
+    // El jugador forma parte del estado inicial del diario: no cambia en
+    // mitad de una grabación
+    bool setJugadorActual(const std::string& nombre) {
+        if (diario != nullptr) {
+            salida() << "⚠️  No se puede cambiar de jugador durante una grabación\n";
+            return false;
+        }
+        jugadorActual = nombre;
+        return true;
+    }
+    const std::string& getJugadorActual() const { return jugadorActual; }
+    
+    // ---- Aleatoriedad reproducible ----
+    void sembrar(uint64_t semilla) {
+        registrar(EVENTO_SEMILLA_BAJA, static_cast<int32_t>(static_cast<uint32_t>(semilla)));
+        registrar(EVENTO_SEMILLA_ALTA, static_cast<int32_t>(static_cast<uint32_t>(semilla >> 32)));
+        generador.sembrar(semilla);
+    }
+    
+    int aleatorio(int n) {
+        registrar(EVENTO_ALEATORIO, n);
+        return generador.rango(n);
+    }
+    
+    void setSilencioso(bool valor) { silencioso = valor; }
+    
+    // ---- Instantáneas ----
+    EstadoJuego tomarInstantanea() const {
+        EstadoJuego e = EstadoJuego();
+        e.nivelActual = nivelActual;
+        e.puntaje = puntaje;
+        e.vidas = vidas;
+        e.puntuacionMaxima = puntuacionMaxima;
+        e.juegoEnCurso = juegoEnCurso ? 1 : 0;
+        e.enemigosEliminados = enemigosEliminados;
+        e.itemsRecolectados = itemsRecolectados;
+        e.estadoAleatorio = generador.getEstado();
+        copiarTextoUtf8(e.jugadorActual, sizeof(e.jugadorActual), jugadorActual);
+        return e;
+    }
+    
+    void restaurarInstantanea(const EstadoJuego& e) {
+        nivelActual = e.nivelActual;
+        puntaje = e.puntaje;
+        vidas = e.vidas;
+        puntuacionMaxima = e.puntuacionMaxima;
+        juegoEnCurso = e.juegoEnCurso != 0;
+        enemigosEliminados = e.enemigosEliminados;
+        itemsRecolectados = e.itemsRecolectados;
+        generador.setEstado(e.estadoAleatorio);
+        jugadorActual = leerTextoFijo(e.jugadorActual, sizeof(e.jugadorActual));
+    }
+    
+    bool guardarPartida(const std::string& ruta) const {
+        return Instantanea::guardar(tomarInstantanea(), ruta);
+    }
+    
+    bool cargarPartida(const std::string& ruta) {
+        EstadoJuego e;
+        if (!Instantanea::cargar(ruta, e)) {
+            salida() << "❌ No se pudo cargar la partida desde " << ruta << "\n";
+            return false;
+        }
+        restaurarInstantanea(e);
+        return true;
+    }
+    
+    // ---- Diario de eventos y reproducción ----
+    void iniciarGrabacion(DiarioEventos* nuevoDiario) {
+        diario = nuevoDiario;
+        if (diario != nullptr) diario->comenzar(tomarInstantanea());
+    }
+    
+    void detenerGrabacion() { diario = nullptr; }
+    
+    // Restaura el estado inicial del diario y aplica cada evento en orden,
+    // sin consola ni esperas; el generador avanza con los aleatorio()
+    // grabados. Devuelve el número de eventos aplicados.
+    size_t reproducir(const DiarioEventos& origen) {
+        DiarioEventos* grabando = diario;
+        TablaRecords* tablaPrevia = tablaRecords;
+        bool silencioPrevio = silencioso;
+        diario = nullptr;
+        tablaRecords = nullptr;
+        silencioso = true;
+        reproduciendo = true;
+        
+        restaurarInstantanea(origen.getEstadoInicial());
+        const std::vector<Evento>& eventos = origen.getEventos();
+        uint32_t semillaBaja = 0;
+        for (size_t i = 0; i < eventos.size(); i++) {
+            switch (eventos[i].tipo) {
+                case EVENTO_INICIAR: iniciarJuego(); break;
+                case EVENTO_FINALIZAR: finalizarJuego(); break;
+                case EVENTO_SUBIR_NIVEL: subirNivel(); break;
+                case EVENTO_SUMAR_PUNTOS: sumarPuntos(eventos[i].valor); break;
+                case EVENTO_PERDER_VIDA: perderVida(); break;
+                case EVENTO_GANAR_VIDA: ganarVida(); break;
+                case EVENTO_ENEMIGO_ELIMINADO: registrarEnemigoEliminado(); break;
+                case EVENTO_ITEM_RECOLECTADO: registrarItemRecolectado(); break;
+                case EVENTO_ALEATORIO:
+                    if (eventos[i].valor != 0) aleatorio(eventos[i].valor);   // rango(0) divide por cero
+                    break;
+                case EVENTO_SEMILLA_BAJA: semillaBaja = static_cast<uint32_t>(eventos[i].valor); break;
+                case EVENTO_SEMILLA_ALTA:
+                    sembrar(semillaBaja | (static_cast<uint64_t>(static_cast<uint32_t>(eventos[i].valor)) << 32));
+                    break;
+            }
+        }
+        
+        diario = grabando;
+        tablaRecords = tablaPrevia;
+        silencioso = silencioPrevio;
+        reproduciendo = false;
+        return eventos.size();
+    }
+    
     static void destruirInstancia() {
         if (instancia != nullptr) {
             delete instancia;
@@ -0,0 +1,122 @@
+#ifndef DIARIOEVENTOS_H
+#define DIARIOEVENTOS_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Instantanea.h"
+
+enum TipoEvento : uint8_t {
+    EVENTO_INICIAR = 1,
+    EVENTO_FINALIZAR,
+    EVENTO_SUBIR_NIVEL,
+    EVENTO_SUMAR_PUNTOS,
+    EVENTO_PERDER_VIDA,
+    EVENTO_GANAR_VIDA,
+    EVENTO_ENEMIGO_ELIMINADO,
+    EVENTO_ITEM_RECOLECTADO,
+    EVENTO_ALEATORIO,            // valor = n de aleatorio(n): avanza el generador
+    EVENTO_SEMILLA_BAJA,         // sembrar(): 32 bits bajos...
+    EVENTO_SEMILLA_ALTA          // ...y altos; se aplica al llegar este
+};
+
+struct Evento {
+    uint8_t tipo;
+    int32_t valor;
+};
+
+// Registro secuencial de todas las mutaciones de ControlJuego junto con el
+// estado inicial (que incluye el estado del generador aleatorio). Cada
+// aleatorio() y sembrar() también es un evento, así que al reproducir el
+// generador termina igual. Con ambos se puede reconstruir la partida
+// completa sin esperas ni E/S.
+class DiarioEventos {
+private:
+    EstadoJuego estadoInicial;
+    std::vector<Evento> eventos;
+
+public:
+    DiarioEventos() : estadoInicial() {}
+    
+    void comenzar(const EstadoJuego& inicial) {
+        estadoInicial = inicial;
+        eventos.clear();
+    }
+    
+    void registrar(TipoEvento tipo, int32_t valor = 0) {
+        Evento e;
+        e.tipo = tipo;
+        e.valor = valor;
+        eventos.push_back(e);
+    }
+    
+    const EstadoJuego& getEstadoInicial() const { return estadoInicial; }
+    const std::vector<Evento>& getEventos() const { return eventos; }
+    size_t tamano() const { return eventos.size(); }
+    
+    // Formato: instantánea inicial | u32 número de eventos | (u8 tipo, i32 valor)*
+    bool guardar(const std::string& ruta) const {
+        std::ofstream archivo(ruta, std::ios::binary | std::ios::trunc);
+        if (!archivo.is_open()) return false;
+        
+        uint8_t cabecera[Instantanea::TAMANO];
+        Instantanea::serializar(estadoInicial, cabecera);
+        archivo.write(reinterpret_cast<const char*>(cabecera), Instantanea::TAMANO);
+        
+        uint32_t n = static_cast<uint32_t>(eventos.size());
+        uint8_t buf[5];
+        for (int i = 0; i < 4; i++) buf[i] = static_cast<uint8_t>(n >> (8 * i));
+        archivo.write(reinterpret_cast<const char*>(buf), 4);
+        
+        for (size_t i = 0; i < eventos.size(); i++) {
+            uint32_t v = static_cast<uint32_t>(eventos[i].valor);
+            buf[0] = eventos[i].tipo;
+            for (int j = 0; j < 4; j++) buf[1 + j] = static_cast<uint8_t>(v >> (8 * j));
+            archivo.write(reinterpret_cast<const char*>(buf), 5);
+        }
+        return archivo.good();
+    }
+    
+    // Rechaza el archivo entero (sin tocar el diario) si está truncado, si
+    // el número de eventos no cuadra con su tamaño o si un tipo no existe
+    bool cargar(const std::string& ruta) {
+        std::ifstream archivo(ruta, std::ios::binary | std::ios::ate);
+        if (!archivo.is_open()) return false;
+        std::streamoff tamanoArchivo = archivo.tellg();
+        archivo.seekg(0);
+        
+        uint8_t cabecera[Instantanea::TAMANO];
+        EstadoJuego inicial;
+        archivo.read(reinterpret_cast<char*>(cabecera), Instantanea::TAMANO);
+        if (!archivo || !Instantanea::deserializar(cabecera, inicial)) return false;
+        
+        uint8_t buf[5];
+        archivo.read(reinterpret_cast<char*>(buf), 4);
+        if (!archivo) return false;
+        uint32_t n = 0;
+        for (int i = 0; i < 4; i++) n |= static_cast<uint32_t>(buf[i]) << (8 * i);
+        // n viene del archivo: se acota por los bytes que quedan antes de reservar
+        std::streamoff restante = tamanoArchivo - static_cast<std::streamoff>(Instantanea::TAMANO + 4);
+        if (static_cast<std::streamoff>(n) * 5 != restante) return false;
+        
+        std::vector<Evento> leidos;
+        leidos.reserve(n);
+        for (uint32_t i = 0; i < n; i++) {
+            archivo.read(reinterpret_cast<char*>(buf), 5);
+            if (!archivo) return false;
+            if (buf[0] < EVENTO_INICIAR || buf[0] > EVENTO_SEMILLA_ALTA) return false;
+            uint32_t v = 0;
+            for (int j = 0; j < 4; j++) v |= static_cast<uint32_t>(buf[1 + j]) << (8 * j);
+            Evento e;
+            e.tipo = buf[0];
+            e.valor = static_cast<int32_t>(v);
+            leidos.push_back(e);
+        }
+        estadoInicial = inicial;
+        eventos.swap(leidos);
+        return true;
+    }
+};
+
+#endif
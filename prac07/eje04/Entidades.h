@@ -0,0 +1,256 @@
+#ifndef ENTIDADES_H
+#define ENTIDADES_H
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "ControlJuego.h"
+
+// Cadenas repetidas (tipos de enemigo, nombres de item) se guardan una sola
+// vez; las entidades solo llevan un índice de 16 bits. internar() lanza
+// std::length_error si se piden más de 65536 nombres distintos.
+class TablaNombres {
+private:
+    static TablaNombres* instancia;
+    std::vector<std::string> nombres;
+    std::unordered_map<std::string, uint16_t> indice;
+    
+    TablaNombres() {}
+    
+    TablaNombres(const TablaNombres&) = delete;
+    TablaNombres& operator=(const TablaNombres&) = delete;
+
+public:
+    static TablaNombres* obtenerInstancia() {
+        if (instancia == nullptr) {
+            instancia = new TablaNombres();
+        }
+        return instancia;
+    }
+    
+    uint16_t internar(const std::string& nombre) {
+        std::unordered_map<std::string, uint16_t>::const_iterator it = indice.find(nombre);
+        if (it != indice.end()) return it->second;
+        // Un id más allá de 65535 daría la vuelta y se confundiría con otro nombre
+        if (nombres.size() > std::numeric_limits<uint16_t>::max()) {
+            throw std::length_error("TablaNombres: más de 65536 nombres distintos");
+        }
+        uint16_t id = static_cast<uint16_t>(nombres.size());
+        nombres.push_back(nombre);
+        indice[nombre] = id;
+        return id;
+    }
+    
+    const std::string& obtener(uint16_t id) const { return nombres[id]; }
+    
+    static void destruirInstancia() {
+        if (instancia != nullptr) {
+            delete instancia;
+            instancia = nullptr;
+        }
+    }
+};
+
+TablaNombres* TablaNombres::instancia = nullptr;
+
+// Referencia a una entidad del pool. La generación invalida los manejadores
+// de entidades ya despachadas aunque su ranura se haya reutilizado.
+struct Manejador {
+    uint32_t indice;
+    uint32_t generacion;
+    
+    Manejador() : indice(0), generacion(0) {}
+    Manejador(uint32_t i, uint32_t g) : indice(i), generacion(g) {}
+    bool valido() const { return generacion != 0; }
+};
+
+// Posición en el plano del nivel (unidades de mundo)
+struct Posicion {
+    float x;
+    float y;
+    
+    Posicion() : x(0), y(0) {}
+    Posicion(float px, float py) : x(px), y(py) {}
+};
+
+// Pool de entidades en bloques de tamaño fijo con lista libre. Las ranuras
+// no se mueven nunca, así que los punteros obtenidos siguen siendo válidos
+// hasta que la entidad se destruye. El número de serie que reciben las
+// entidades al crearse sustituye a los contadores estáticos por clase.
+template <typename T, uint32_t TAM_BLOQUE = 1024>
+class PoolEntidades {
+private:
+    struct Bloque {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type ranuras[TAM_BLOQUE];
+    };
+    
+    std::vector<std::unique_ptr<Bloque> > bloques;
+    std::vector<uint32_t> generaciones;   // impar = ranura ocupada
+    std::vector<uint32_t> libres;
+    uint32_t contador;
+    size_t activos;
+    
+    T* ranura(uint32_t i) {
+        return reinterpret_cast<T*>(&bloques[i / TAM_BLOQUE]->ranuras[i % TAM_BLOQUE]);
+    }
+
+public:
+    PoolEntidades() : contador(0), activos(0) {}
+    
+    ~PoolEntidades() { vaciar(); }
+    
+    PoolEntidades(const PoolEntidades&) = delete;
+    PoolEntidades& operator=(const PoolEntidades&) = delete;
+    
+    template <typename... Args>
+    Manejador crear(Args&&... args) {
+        uint32_t i;
+        if (!libres.empty()) {
+            i = libres.back();
+            libres.pop_back();
+        } else {
+            i = static_cast<uint32_t>(generaciones.size());
+            if (i % TAM_BLOQUE == 0) bloques.push_back(std::unique_ptr<Bloque>(new Bloque));
+            generaciones.push_back(0);
+        }
+        new (ranura(i)) T(++contador, std::forward<Args>(args)...);
+        activos++;
+        return Manejador(i, ++generaciones[i]);
+    }
+    
+    T* obtener(Manejador m) {
+        if (m.indice >= generaciones.size() || generaciones[m.indice] != m.generacion) {
+            return nullptr;
+        }
+        return ranura(m.indice);
+    }
+    
+    bool destruir(Manejador m) {
+        T* entidad = obtener(m);
+        if (entidad == nullptr) return false;
+        entidad->~T();
+        generaciones[m.indice]++;
+        libres.push_back(m.indice);
+        activos--;
+        return true;
+    }
+    
+    void vaciar() {
+        for (uint32_t i = 0; i < generaciones.size(); i++) {
+            if (generaciones[i] & 1) {
+                ranura(i)->~T();
+                generaciones[i]++;
+                libres.push_back(i);
+            }
+        }
+        activos = 0;
+    }
+    
+    size_t getActivos() const { return activos; }
+    uint32_t getCreados() const { return contador; }
+    
+    // Recorre las entidades vivas (orden de ranura)
+    template <typename F>
+    void paraCada(F f) {
+        for (uint32_t i = 0; i < generaciones.size(); i++) {
+            if (generaciones[i] & 1) f(*ranura(i));
+        }
+    }
+    
+    // Igual que paraCada, pasando también el manejador de cada entidad
+    template <typename F>
+    void paraCadaConManejador(F f) {
+        for (uint32_t i = 0; i < generaciones.size(); i++) {
+            if (generaciones[i] & 1) f(Manejador(i, generaciones[i]), *ranura(i));
+        }
+    }
+};
+
+class Enemigo {
+private:
+    uint32_t numero;
+    uint16_t tipo;
+    int vida;
+    int puntosOtorgados;
+    Posicion posicion;
+    ControlJuego* control;
+public:
+    Enemigo(uint32_t serie, const std::string& tipoEnemigo = "Básico", Posicion p = Posicion())
+        : numero(serie), tipo(TablaNombres::obtenerInstancia()->internar(tipoEnemigo)),
+          vida(100), puntosOtorgados(tipoEnemigo == "Básico" ? 50 : 150), posicion(p),
+          control(ControlJuego::obtenerInstancia()) {}
+    
+    // El nombre solo se construye cuando se va a mostrar
+    std::string getNombre() const {
+        return TablaNombres::obtenerInstancia()->obtener(tipo) + " #" + std::to_string(numero);
+    }
+    
+    bool estaVivo() const { return vida > 0; }
+    
+    const Posicion& getPosicion() const { return posicion; }
+    void moverA(Posicion p) { posicion = p; }
+    
+    void recibirDano() {
+        vida -= (control->aleatorio(31) + 30);
+        std::cout << "   💥 " << getNombre() << " recibió daño (Vida: " << (vida > 0 ? vida : 0) << ")\n";
+        
+        if (vida <= 0) {
+            eliminar();
+        }
+    }
+    
+    void eliminar() {
+        std::cout << "   ☠️  " << getNombre() << " eliminado\n";
+        control->sumarPuntos(puntosOtorgados);
+        control->registrarEnemigoEliminado();
+    }
+};
+
+class Item {
+private:
+    uint16_t nombre;
+    uint16_t tipo;
+    Posicion posicion;
+    ControlJuego* control;
+public:
+    Item(uint32_t, const std::string& n, const std::string& t, Posicion p = Posicion())
+        : nombre(TablaNombres::obtenerInstancia()->internar(n)),
+          tipo(TablaNombres::obtenerInstancia()->internar(t)), posicion(p),
+          control(ControlJuego::obtenerInstancia()) {}
+    
+    const std::string& getNombre() const {
+        return TablaNombres::obtenerInstancia()->obtener(nombre);
+    }
+    
+    const Posicion& getPosicion() const { return posicion; }
+    void moverA(Posicion p) { posicion = p; }
+    
+    void aplicarEfecto() {
+        control->registrarItemRecolectado();
+        
+        const std::string& t = TablaNombres::obtenerInstancia()->obtener(tipo);
+        if (t == "puntos") {
+            int puntos = control->aleatorio(201) + 100;
+            control->sumarPuntos(puntos);
+            std::cout << "   ⭐ Ganaste " << puntos << " puntos\n";
+        } else if (t == "vida") {
+            control->ganarVida();
+        } else if (t == "poder") {
+            int puntos = 500;
+            control->sumarPuntos(puntos);
+            std::cout << "   ⚡ ¡Poder especial activado! +" << puntos << " puntos\n";
+        }
+    }
+};
+
+typedef PoolEntidades<Enemigo> PoolEnemigos;
+typedef PoolEntidades<Item> PoolItems;
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef GENERADORALEATORIO_H
+#define GENERADORALEATORIO_H
+
+#include <cstdint>
+
+// Generador xorshift64* con semilla explícita. A diferencia de rand(), su
+// estado es un único entero de 64 bits que puede guardarse en una
+// instantánea y restaurarse, lo que hace reproducible toda la partida.
+class GeneradorAleatorio {
+private:
+    uint64_t estado;
+
+public:
+    explicit GeneradorAleatorio(uint64_t semilla = 0x9E3779B97F4A7C15ULL) {
+        sembrar(semilla);
+    }
+    
+    void sembrar(uint64_t semilla) {
+        // El estado nunca puede ser cero en xorshift
+        estado = semilla ? semilla : 0x9E3779B97F4A7C15ULL;
+    }
+    
+    uint64_t siguiente() {
+        estado ^= estado >> 12;
+        estado ^= estado << 25;
+        estado ^= estado >> 27;
+        return estado * 0x2545F4914F6CDD1DULL;
+    }
+    
+    // Entero uniforme en [0, n)
+    int rango(int n) {
+        return static_cast<int>((siguiente() >> 33) % static_cast<uint64_t>(n));
+    }
+    
+    uint64_t getEstado() const { return estado; }
+    void setEstado(uint64_t nuevoEstado) { estado = nuevoEstado; }
+};
+
+#endif
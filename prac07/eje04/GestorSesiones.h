@@ -0,0 +1,244 @@
+#ifndef GESTORSESIONES_H
+#define GESTORSESIONES_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "ControlJuego.h"
+#include "../comun/Metricas.h"
+
+// Identificador de sesión: [generación:32 | índice local:24 | fragmento:8].
+// El id 0 está reservado para la sesión por defecto (ControlJuego::obtenerInstancia()).
+typedef uint64_t IdSesion;
+
+// Un fragmento es dueño exclusivo de sus sesiones: solo su hilo trabajador
+// las crea, modifica y destruye, por lo que el estado de juego no necesita
+// ningún lock. El único punto compartido es su propia cola de comandos.
+class FragmentoSesiones {
+private:
+    static const uint32_t SESIONES_POR_BLOQUE = 256;
+    
+    struct Bloque {
+        typename std::aligned_storage<sizeof(ControlJuego), alignof(ControlJuego)>::type
+            ranuras[SESIONES_POR_BLOQUE];
+    };
+    
+    uint32_t indice;
+    std::vector<std::unique_ptr<Bloque> > bloques;
+    std::vector<uint32_t> generaciones;   // impar = ranura ocupada
+    std::vector<uint32_t> libres;
+    size_t activas;
+    Medidor metricaActivas;   // suma de todos los fragmentos
+    
+    std::mutex mutexCola;
+    std::condition_variable hayTrabajo;
+    std::deque<std::function<void()> > cola;
+    bool detenido;
+    std::thread trabajador;
+    
+    ControlJuego* ranura(uint32_t local) {
+        Bloque* b = bloques[local / SESIONES_POR_BLOQUE].get();
+        return reinterpret_cast<ControlJuego*>(&b->ranuras[local % SESIONES_POR_BLOQUE]);
+    }
+    
+    void bucle() {
+        std::deque<std::function<void()> > lote;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutexCola);
+                hayTrabajo.wait(lock, [this] { return detenido || !cola.empty(); });
+                if (cola.empty() && detenido) return;
+                lote.swap(cola);
+            }
+            // El lote completo se procesa sin tocar el mutex
+            while (!lote.empty()) {
+                lote.front()();
+                lote.pop_front();
+            }
+        }
+    }
+
+public:
+    explicit FragmentoSesiones(uint32_t idx)
+        : indice(idx), activas(0),
+          metricaActivas("prac07_juego_sesiones_activas", "Sesiones vivas en el GestorSesiones"),
+          detenido(false) {
+        trabajador = std::thread(&FragmentoSesiones::bucle, this);
+    }
+    
+    ~FragmentoSesiones() {
+        detener();
+        for (uint32_t i = 0; i < generaciones.size(); i++) {
+            if (generaciones[i] & 1) ranura(i)->~ControlJuego();
+        }
+        metricaActivas.sumar(-static_cast<int64_t>(activas));
+    }
+    
+    FragmentoSesiones(const FragmentoSesiones&) = delete;
+    FragmentoSesiones& operator=(const FragmentoSesiones&) = delete;
+    
+    // false si el fragmento ya está detenido: la tarea no se ejecutará
+    bool encolar(std::function<void()> tarea) {
+        {
+            std::lock_guard<std::mutex> lock(mutexCola);
+            if (detenido) return false;
+            cola.push_back(std::move(tarea));
+        }
+        hayTrabajo.notify_one();
+        return true;
+    }
+    
+    // Termina los comandos pendientes y une el hilo trabajador
+    void detener() {
+        {
+            std::lock_guard<std::mutex> lock(mutexCola);
+            if (detenido) return;
+            detenido = true;
+        }
+        hayTrabajo.notify_one();
+        trabajador.join();
+    }
+    
+    // ---- Solo desde el hilo del fragmento ----
+    IdSesion crear() {
+        uint32_t local;
+        if (!libres.empty()) {
+            local = libres.back();
+            libres.pop_back();
+        } else {
+            local = static_cast<uint32_t>(generaciones.size());
+            if (local % SESIONES_POR_BLOQUE == 0) {
+                bloques.push_back(std::unique_ptr<Bloque>(new Bloque));
+            }
+            generaciones.push_back(0);
+        }
+        ControlJuego* c = new (ranura(local)) ControlJuego();
+        c->setSilencioso(true);
+        generaciones[local]++;
+        activas++;
+        metricaActivas.sumar(1);
+        return (static_cast<uint64_t>(generaciones[local]) << 32) |
+               (static_cast<uint64_t>(local) << 8) | indice;
+    }
+    
+    ControlJuego* buscar(IdSesion id) {
+        uint32_t local = static_cast<uint32_t>(id >> 8) & 0xFFFFFF;
+        uint32_t generacion = static_cast<uint32_t>(id >> 32);
+        if (local >= generaciones.size() || generaciones[local] != generacion) return nullptr;
+        return ranura(local);
+    }
+    
+    bool destruir(IdSesion id) {
+        ControlJuego* c = buscar(id);
+        if (c == nullptr) return false;
+        uint32_t local = static_cast<uint32_t>(id >> 8) & 0xFFFFFF;
+        c->~ControlJuego();
+        generaciones[local]++;
+        libres.push_back(local);
+        activas--;
+        metricaActivas.sumar(-1);
+        return true;
+    }
+    
+    size_t getActivas() const { return activas; }
+};
+
+// Aloja miles de partidas independientes en un proceso. Cada sesión vive en
+// el slab de un fragmento y todas sus operaciones se ejecutan en el hilo de
+// ese fragmento, en orden de llegada.
+class GestorSesiones {
+private:
+    std::vector<std::unique_ptr<FragmentoSesiones> > fragmentos;
+    std::atomic<uint32_t> siguiente;
+    
+    FragmentoSesiones& fragmentoDe(IdSesion id) {
+        return *fragmentos[(id & 0xFF) % fragmentos.size()];
+    }
+    
+    static std::exception_ptr errorDetenido() {
+        return std::make_exception_ptr(std::runtime_error("GestorSesiones: gestor detenido"));
+    }
+
+public:
+    explicit GestorSesiones(uint32_t numFragmentos = std::thread::hardware_concurrency())
+        : siguiente(0) {
+        if (numFragmentos == 0) numFragmentos = 1;
+        if (numFragmentos > 255) numFragmentos = 255;
+        for (uint32_t i = 0; i < numFragmentos; i++) {
+            fragmentos.push_back(std::unique_ptr<FragmentoSesiones>(new FragmentoSesiones(i)));
+        }
+    }
+    
+    ~GestorSesiones() { detener(); }
+    
+    GestorSesiones(const GestorSesiones&) = delete;
+    GestorSesiones& operator=(const GestorSesiones&) = delete;
+    
+    static const IdSesion SESION_POR_DEFECTO = 0;
+    
+    std::future<IdSesion> crearSesion() {
+        uint32_t f = siguiente.fetch_add(1, std::memory_order_relaxed) % fragmentos.size();
+        FragmentoSesiones* frag = fragmentos[f].get();
+        std::shared_ptr<std::promise<IdSesion> > promesa(new std::promise<IdSesion>());
+        std::future<IdSesion> resultado = promesa->get_future();
+        if (!frag->encolar([frag, promesa] { promesa->set_value(frag->crear()); })) {
+            promesa->set_exception(errorDetenido());
+        }
+        return resultado;
+    }
+    
+    // Ejecuta la acción sobre la sesión en el hilo de su fragmento. La sesión
+    // por defecto se atiende en el hilo llamador, igual que el singleton.
+    // Devuelve false (y la acción no se ejecuta) tras detener().
+    bool enviar(IdSesion id, std::function<void(ControlJuego&)> accion) {
+        if (id == SESION_POR_DEFECTO) {
+            accion(*ControlJuego::obtenerInstancia());
+            return true;
+        }
+        FragmentoSesiones* frag = &fragmentoDe(id);
+        return frag->encolar([frag, id, accion] {
+            ControlJuego* c = frag->buscar(id);
+            if (c != nullptr) accion(*c);
+        });
+    }
+    
+    // Como enviar(), pero devuelve una instantánea del estado tras la acción
+    std::future<EstadoJuego> consultar(IdSesion id,
+                                       std::function<void(ControlJuego&)> accion = nullptr) {
+        std::shared_ptr<std::promise<EstadoJuego> > promesa(new std::promise<EstadoJuego>());
+        std::future<EstadoJuego> resultado = promesa->get_future();
+        bool aceptada = enviar(id, [accion, promesa](ControlJuego& c) {
+            if (accion) accion(c);
+            promesa->set_value(c.tomarInstantanea());
+        });
+        if (!aceptada) promesa->set_exception(errorDetenido());
+        return resultado;
+    }
+    
+    void cerrarSesion(IdSesion id) {
+        if (id == SESION_POR_DEFECTO) return;
+        FragmentoSesiones* frag = &fragmentoDe(id);
+        // Tras detener() no hace falta: el fragmento destruye sus sesiones
+        frag->encolar([frag, id] { frag->destruir(id); });
+    }
+    
+    size_t getNumFragmentos() const { return fragmentos.size(); }
+    
+    // Termina lo ya encolado; después crearSesion() y consultar() devuelven
+    // futuros con excepción y enviar() devuelve false
+    void detener() {
+        for (size_t i = 0; i < fragmentos.size(); i++) fragmentos[i]->detener();
+    }
+};
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef INDICEESPACIAL_H
+#define INDICEESPACIAL_H
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "Entidades.h"
+
+// Rejilla uniforme sobre un hash espacial: el plano se divide en celdas de
+// `tamCelda` unidades y cada celda (cx, cy) cae en uno de `numCubetas`
+// cubetas. El mundo no tiene límites y dos celdas pueden compartir cubeta;
+// cada entrada guarda su celda, así que las consultas descartan las ajenas y
+// nunca devuelven una entidad dos veces.
+//
+// Una consulta de radio o de caja solo recorre las cubetas de las celdas que
+// toca: el coste depende de las entidades cercanas, no del total. Con
+// tamCelda del orden del radio típico de consulta se visitan 4-9 celdas.
+//
+// sincronizar(pool) se llama una vez por tick: solo cambian de cubeta las
+// entidades que cruzaron de celda y se quitan las que el pool ya despachó.
+class IndiceEspacial {
+private:
+    struct Entrada {
+        Manejador manejador;
+        float x;
+        float y;
+        int32_t cx;
+        int32_t cy;
+    };
+
+    // Dónde está cada ranura del pool (indexado por Manejador::indice)
+    struct Ubicacion {
+        uint32_t generacion;   // 0 = no está en el índice
+        uint32_t cubeta;
+        uint32_t posicion;
+    };
+
+    float tamCelda;
+    float inverso;
+    uint32_t mascara;
+    std::vector<std::vector<Entrada> > cubetas;
+    std::vector<Ubicacion> ubicaciones;
+    size_t numEntradas;
+    size_t cambiosDeCelda;
+
+    int32_t celda(float v) const { return static_cast<int32_t>(std::floor(v * inverso)); }
+
+    uint32_t cubeta(int32_t cx, int32_t cy) const {
+        return (static_cast<uint32_t>(cx) * 73856093u ^ static_cast<uint32_t>(cy) * 19349663u) & mascara;
+    }
+
+    Ubicacion& ubicacion(uint32_t indice) {
+        if (indice >= ubicaciones.size()) {
+            Ubicacion vacia = {0, 0, 0};
+            ubicaciones.resize(indice + 1, vacia);
+        }
+        return ubicaciones[indice];
+    }
+
+    void anadir(Manejador m, Posicion p, int32_t cx, int32_t cy) {
+        uint32_t c = cubeta(cx, cy);
+        Entrada e = {m, p.x, p.y, cx, cy};
+        Ubicacion& u = ubicacion(m.indice);
+        u.generacion = m.generacion;
+        u.cubeta = c;
+        u.posicion = static_cast<uint32_t>(cubetas[c].size());
+        cubetas[c].push_back(e);
+    }
+
+    // Quita por intercambio con la última entrada de la cubeta
+    void retirar(Ubicacion& u) {
+        std::vector<Entrada>& lista = cubetas[u.cubeta];
+        Entrada& ultima = lista.back();
+        ubicaciones[ultima.manejador.indice].posicion = u.posicion;
+        lista[u.posicion] = ultima;
+        lista.pop_back();
+        u.generacion = 0;
+    }
+
+    // Recorre las entradas cuya celda está en [cx0, cx1] x [cy0, cy1]
+    template <typename F>
+    void recorrerCeldas(int32_t cx0, int32_t cy0, int32_t cx1, int32_t cy1, F f) const {
+        uint64_t celdas = static_cast<uint64_t>(cx1 - cx0 + 1) * static_cast<uint64_t>(cy1 - cy0 + 1);
+        if (celdas >= cubetas.size()) {
+            // Consulta más grande que la tabla: cada cubeta una sola vez
+            for (size_t c = 0; c < cubetas.size(); c++) {
+                for (size_t i = 0; i < cubetas[c].size(); i++) {
+                    const Entrada& e = cubetas[c][i];
+                    if (e.cx >= cx0 && e.cx <= cx1 && e.cy >= cy0 && e.cy <= cy1) f(e);
+                }
+            }
+            return;
+        }
+        for (int32_t cy = cy0; cy <= cy1; cy++) {
+            for (int32_t cx = cx0; cx <= cx1; cx++) {
+                const std::vector<Entrada>& lista = cubetas[cubeta(cx, cy)];
+                for (size_t i = 0; i < lista.size(); i++) {
+                    if (lista[i].cx == cx && lista[i].cy == cy) f(lista[i]);
+                }
+            }
+        }
+    }
+
+public:
+    // numCubetas se redondea a potencia de 2
+    explicit IndiceEspacial(float tamanoCelda = 4.0f, uint32_t numCubetas = 4096)
+        : tamCelda(tamanoCelda), inverso(1.0f / tamanoCelda), mascara(0), numEntradas(0), cambiosDeCelda(0) {
+        uint32_t n = 1;
+        while (n < numCubetas) n <<= 1;
+        mascara = n - 1;
+        cubetas.resize(n);
+    }
+
+    void insertar(Manejador m, Posicion p) {
+        Ubicacion& u = ubicacion(m.indice);
+        if (u.generacion != 0) retirar(u);
+        else numEntradas++;
+        anadir(m, p, celda(p.x), celda(p.y));
+    }
+
+    // Actualiza la posición; solo cambia de cubeta si cambió de celda
+    void mover(Manejador m, Posicion p) {
+        if (m.indice >= ubicaciones.size() || ubicaciones[m.indice].generacion != m.generacion) {
+            insertar(m, p);
+            return;
+        }
+        Ubicacion& u = ubicaciones[m.indice];
+        Entrada& e = cubetas[u.cubeta][u.posicion];
+        int32_t cx = celda(p.x), cy = celda(p.y);
+        if (cx == e.cx && cy == e.cy) {
+            e.x = p.x;
+            e.y = p.y;
+            return;
+        }
+        retirar(u);
+        anadir(m, p, cx, cy);
+        cambiosDeCelda++;
+    }
+
+    bool quitar(Manejador m) {
+        if (m.indice >= ubicaciones.size() || ubicaciones[m.indice].generacion != m.generacion) return false;
+        retirar(ubicaciones[m.indice]);
+        numEntradas--;
+        return true;
+    }
+
+    // Pone el índice al día con las entidades vivas del pool (T::getPosicion())
+    template <typename T, uint32_t TAM_BLOQUE>
+    void sincronizar(PoolEntidades<T, TAM_BLOQUE>& pool) {
+        for (uint32_t i = 0; i < ubicaciones.size(); i++) {
+            Ubicacion& u = ubicaciones[i];
+            if (u.generacion != 0 && pool.obtener(Manejador(i, u.generacion)) == nullptr) {
+                retirar(u);
+                numEntradas--;
+            }
+        }
+        pool.paraCadaConManejador([this](Manejador m, T& entidad) { mover(m, entidad.getPosicion()); });
+    }
+
+    // f(Manejador, Posicion) por cada entidad a distancia <= radio del centro
+    template <typename F>
+    void enRadio(Posicion centro, float radio, F f) const {
+        float r2 = radio * radio;
+        recorrerCeldas(celda(centro.x - radio), celda(centro.y - radio),
+                       celda(centro.x + radio), celda(centro.y + radio), [&](const Entrada& e) {
+            float dx = e.x - centro.x, dy = e.y - centro.y;
+            if (dx * dx + dy * dy <= r2) f(e.manejador, Posicion(e.x, e.y));
+        });
+    }
+
+    // f(Manejador, Posicion) por cada entidad dentro de la caja [minimo, maximo]
+    template <typename F>
+    void enCaja(Posicion minimo, Posicion maximo, F f) const {
+        recorrerCeldas(celda(minimo.x), celda(minimo.y), celda(maximo.x), celda(maximo.y),
+                       [&](const Entrada& e) {
+            if (e.x >= minimo.x && e.x <= maximo.x && e.y >= minimo.y && e.y <= maximo.y) {
+                f(e.manejador, Posicion(e.x, e.y));
+            }
+        });
+    }
+
+    void vaciar() {
+        for (size_t c = 0; c < cubetas.size(); c++) cubetas[c].clear();
+        ubicaciones.clear();
+        numEntradas = 0;
+    }
+
+    size_t getNumEntradas() const { return numEntradas; }
+    size_t getCambiosDeCelda() const { return cambiosDeCelda; }
+    float getTamCelda() const { return tamCelda; }
+};
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef INSTANTANEA_H
+#define INSTANTANEA_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include "TextoUtf8.h"
+
+// Estado completo de ControlJuego en un bloque de tamaño fijo. Al ser un
+// tipo trivialmente copiable, tomar una instantánea es una copia de pocos
+// bytes (O(1)) y no detiene el bucle del juego.
+struct EstadoJuego {
+    int32_t nivelActual;
+    int32_t puntaje;
+    int32_t vidas;
+    int32_t puntuacionMaxima;
+    int32_t juegoEnCurso;
+    int32_t enemigosEliminados;
+    int32_t itemsRecolectados;
+    uint64_t estadoAleatorio;
+    char jugadorActual[32];     // UTF-8 terminado en '\0'
+};
+
+// Campo a campo: el relleno entre campos no cuenta
+inline bool operator==(const EstadoJuego& a, const EstadoJuego& b) {
+    return a.nivelActual == b.nivelActual && a.puntaje == b.puntaje && a.vidas == b.vidas &&
+           a.puntuacionMaxima == b.puntuacionMaxima && a.juegoEnCurso == b.juegoEnCurso &&
+           a.enemigosEliminados == b.enemigosEliminados && a.itemsRecolectados == b.itemsRecolectados &&
+           a.estadoAleatorio == b.estadoAleatorio &&
+           std::strncmp(a.jugadorActual, b.jugadorActual, sizeof(a.jugadorActual)) == 0;
+}
+
+inline bool operator!=(const EstadoJuego& a, const EstadoJuego& b) { return !(a == b); }
+
+// Formato binario compacto (little-endian):
+//   "CJSV" | version u16 | reservado u16 | 7 x i32 | u64 rng | jugador 32 B | FNV-1a u32
+class Instantanea {
+public:
+    static const size_t TAM_JUGADOR = sizeof(EstadoJuego().jugadorActual);
+    static const size_t TAMANO = 4 + 2 + 2 + 7 * 4 + 8 + TAM_JUGADOR + 4;
+    static const uint16_t VERSION = 2;
+
+private:
+    static void escribirU32(uint8_t* p, uint32_t v) {
+        for (int i = 0; i < 4; i++) p[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+    
+    static uint32_t leerU32(const uint8_t* p) {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; i++) v |= static_cast<uint32_t>(p[i]) << (8 * i);
+        return v;
+    }
+    
+    static uint32_t fnv1a(const uint8_t* datos, size_t n) {
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < n; i++) {
+            h ^= datos[i];
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+public:
+    static void serializar(const EstadoJuego& estado, uint8_t* buffer) {
+        uint8_t* p = buffer;
+        std::memcpy(p, "CJSV", 4); p += 4;
+        *p++ = static_cast<uint8_t>(VERSION);
+        *p++ = static_cast<uint8_t>(VERSION >> 8);
+        *p++ = 0;
+        *p++ = 0;
+        const int32_t campos[7] = {
+            estado.nivelActual, estado.puntaje, estado.vidas,
+            estado.puntuacionMaxima, estado.juegoEnCurso,
+            estado.enemigosEliminados, estado.itemsRecolectados
+        };
+        for (int i = 0; i < 7; i++, p += 4) {
+            escribirU32(p, static_cast<uint32_t>(campos[i]));
+        }
+        escribirU32(p, static_cast<uint32_t>(estado.estadoAleatorio)); p += 4;
+        escribirU32(p, static_cast<uint32_t>(estado.estadoAleatorio >> 32)); p += 4;
+        copiarTextoUtf8(reinterpret_cast<char*>(p), TAM_JUGADOR,
+                        leerTextoFijo(estado.jugadorActual, TAM_JUGADOR));
+        p += TAM_JUGADOR;
+        escribirU32(p, fnv1a(buffer, TAMANO - 4));
+    }
+    
+    static bool deserializar(const uint8_t* buffer, EstadoJuego& estado) {
+        if (std::memcmp(buffer, "CJSV", 4) != 0) return false;
+        uint16_t version = static_cast<uint16_t>(buffer[4] | (buffer[5] << 8));
+        if (version != VERSION) return false;
+        if (leerU32(buffer + TAMANO - 4) != fnv1a(buffer, TAMANO - 4)) return false;
+        
+        const uint8_t* p = buffer + 8;
+        int32_t campos[7];
+        for (int i = 0; i < 7; i++, p += 4) {
+            campos[i] = static_cast<int32_t>(leerU32(p));
+        }
+        estado.nivelActual = campos[0];
+        estado.puntaje = campos[1];
+        estado.vidas = campos[2];
+        estado.puntuacionMaxima = campos[3];
+        estado.juegoEnCurso = campos[4];
+        estado.enemigosEliminados = campos[5];
+        estado.itemsRecolectados = campos[6];
+        estado.estadoAleatorio = leerU32(p) | (static_cast<uint64_t>(leerU32(p + 4)) << 32);
+        p += 8;
+        if (p[TAM_JUGADOR - 1] != 0) return false;
+        std::memcpy(estado.jugadorActual, p, TAM_JUGADOR);
+        return true;
+    }
+    
+    static bool guardar(const EstadoJuego& estado, const std::string& ruta) {
+        uint8_t buffer[TAMANO];
+        serializar(estado, buffer);
+        std::ofstream archivo(ruta, std::ios::binary | std::ios::trunc);
+        if (!archivo.is_open()) return false;
+        archivo.write(reinterpret_cast<const char*>(buffer), TAMANO);
+        return archivo.good();
+    }
+    
+    static bool cargar(const std::string& ruta, EstadoJuego& estado) {
+        uint8_t buffer[TAMANO];
+        std::ifstream archivo(ruta, std::ios::binary);
+        if (!archivo.is_open()) return false;
+        archivo.read(reinterpret_cast<char*>(buffer), TAMANO);
+        if (archivo.gcount() != static_cast<std::streamsize>(TAMANO)) return false;
+        return deserializar(buffer, estado);
+    }
+};
+
+// Estado publicado con un seqlock: el bucle del juego escribe con la
+// secuencia impar y la deja par al terminar; un lector (p. ej. un guardado
+// en segundo plano) copia el estado y reintenta si la secuencia era impar o
+// cambió mientras copiaba, así que nunca ve una mezcla de dos publicaciones
+// por lento que sea. Las palabras son atómicas para que la copia concurrente
+// no sea una carrera de datos.
+class DobleBufferEstado {
+private:
+    static const size_t PALABRAS = (sizeof(EstadoJuego) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> palabras[PALABRAS];
+    std::atomic<uint32_t> secuencia;
+
+public:
+    DobleBufferEstado() : secuencia(0) {
+        for (size_t i = 0; i < PALABRAS; i++) palabras[i].store(0, std::memory_order_relaxed);
+    }
+    
+    void publicar(const EstadoJuego& estado) {
+        uint64_t copia[PALABRAS] = {};
+        std::memcpy(copia, &estado, sizeof(EstadoJuego));
+        // Si hubiera dos escritores, el segundo espera a que la secuencia sea par
+        uint32_t s = secuencia.load(std::memory_order_relaxed);
+        do {
+            while (s & 1) s = secuencia.load(std::memory_order_relaxed);
+        } while (!secuencia.compare_exchange_weak(s, s + 1, std::memory_order_acquire,
+                                                  std::memory_order_relaxed));
+        // release: quien lea una palabra nueva verá también la secuencia impar
+        for (size_t i = 0; i < PALABRAS; i++) palabras[i].store(copia[i], std::memory_order_release);
+        secuencia.store(s + 2, std::memory_order_release);
+    }
+    
+    EstadoJuego leer() const {
+        uint64_t copia[PALABRAS];
+        uint32_t antes, despues;
+        do {
+            antes = secuencia.load(std::memory_order_acquire);
+            for (size_t i = 0; i < PALABRAS; i++) copia[i] = palabras[i].load(std::memory_order_acquire);
+            despues = secuencia.load(std::memory_order_relaxed);
+        } while ((antes & 1) || antes != despues);
+        EstadoJuego estado;
+        std::memcpy(&estado, copia, sizeof(EstadoJuego));
+        return estado;
+    }
+};
+
+#endif
@@ -0,0 +1,303 @@
+#ifndef TABLARECORDS_H
+#define TABLARECORDS_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "TextoUtf8.h"
+
+// Tabla de récords persistente en un archivo proyectado en memoria.
+//
+// Disposición fija: dos ranuras idénticas, cada una con su número de
+// secuencia y checksum. Una confirmación copia la ranura vigente sobre la
+// otra, aplica el cambio, hace msync y solo entonces la nueva ranura pasa a
+// ser la vigente (la de mayor secuencia con checksum válido). Si el proceso
+// muere a mitad de escritura, el checksum falla y se conserva la anterior.
+//
+// Cada tabla (0 = histórica, 1..NIVELES_MAX = por nivel alcanzado) guarda
+// TOP_N registros ordenados por puntaje y un índice ordenado por nombre,
+// ambos consultados con búsqueda binaria.
+class TablaRecords {
+public:
+    static const int TOP_N = 10;
+    static const int NIVELES_MAX = 16;
+    static const int NUM_TABLAS = NIVELES_MAX + 1;
+    static const int TAM_NOMBRE = 32;
+
+    struct Registro {
+        char nombre[TAM_NOMBRE];
+        int32_t puntaje;
+        int32_t nivel;
+    };
+
+private:
+    struct Tabla {
+        int32_t cantidad;
+        uint8_t porNombre[TOP_N];   // posiciones en 'registros', ordenadas por nombre
+        uint8_t relleno[2];
+        Registro registros[TOP_N];  // ordenados por puntaje descendente
+    };
+
+    struct Ranura {
+        uint64_t secuencia;
+        uint32_t checksum;
+        uint32_t relleno;
+        Tabla tablas[NUM_TABLAS];
+    };
+
+    struct Archivo {
+        char magico[8];
+        Ranura ranuras[2];
+    };
+
+    std::string ruta;
+    int descriptor;
+    Archivo* mapa;
+    std::mutex mutexTabla;
+
+    static uint32_t fnv1a(const uint8_t* datos, size_t n) {
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < n; i++) {
+            h ^= datos[i];
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    static uint32_t calcularChecksum(const Ranura& r) {
+        return fnv1a(reinterpret_cast<const uint8_t*>(&r.tablas), sizeof(r.tablas)) ^
+               static_cast<uint32_t>(r.secuencia);
+    }
+
+    static bool valida(const Ranura& r) {
+        return r.checksum == calcularChecksum(r);
+    }
+
+    int ranuraVigente() const {
+        bool v0 = valida(mapa->ranuras[0]);
+        bool v1 = valida(mapa->ranuras[1]);
+        if (v0 && v1) {
+            return mapa->ranuras[1].secuencia > mapa->ranuras[0].secuencia ? 1 : 0;
+        }
+        return v1 ? 1 : 0;
+    }
+
+    static int indiceTabla(int nivel) {
+        if (nivel < 1) return 1;
+        return nivel > NIVELES_MAX ? NIVELES_MAX : nivel;
+    }
+
+    // Primera posición en porNombre cuyo nombre es >= al buscado
+    static int buscarNombre(const Tabla& t, const char* nombre) {
+        int bajo = 0, alto = t.cantidad;
+        while (bajo < alto) {
+            int medio = (bajo + alto) / 2;
+            if (std::strncmp(t.registros[t.porNombre[medio]].nombre, nombre, TAM_NOMBRE) < 0) {
+                bajo = medio + 1;
+            } else {
+                alto = medio;
+            }
+        }
+        return bajo;
+    }
+
+    // Primera posición con puntaje estrictamente menor (empates: antigüedad primero)
+    static int buscarPuntaje(const Tabla& t, int32_t puntaje) {
+        int bajo = 0, alto = t.cantidad;
+        while (bajo < alto) {
+            int medio = (bajo + alto) / 2;
+            if (t.registros[medio].puntaje >= puntaje) {
+                bajo = medio + 1;
+            } else {
+                alto = medio;
+            }
+        }
+        return bajo;
+    }
+
+    static void reconstruirIndice(Tabla& t) {
+        // TOP_N es pequeño: inserción directa sobre el índice
+        for (int i = 0; i < t.cantidad; i++) {
+            int j = i;
+            uint8_t pos = static_cast<uint8_t>(i);
+            while (j > 0 && std::strncmp(t.registros[t.porNombre[j - 1]].nombre,
+                                         t.registros[pos].nombre, TAM_NOMBRE) > 0) {
+                t.porNombre[j] = t.porNombre[j - 1];
+                j--;
+            }
+            t.porNombre[j] = pos;
+        }
+    }
+
+    static bool insertarEn(Tabla& t, const Registro& nuevo) {
+        int posNombre = buscarNombre(t, nuevo.nombre);
+        if (posNombre < t.cantidad &&
+            std::strncmp(t.registros[t.porNombre[posNombre]].nombre, nuevo.nombre, TAM_NOMBRE) == 0) {
+            int previo = t.porNombre[posNombre];
+            if (t.registros[previo].puntaje >= nuevo.puntaje) return false;
+            // El jugador mejora su marca: se retira la entrada anterior
+            std::memmove(&t.registros[previo], &t.registros[previo + 1],
+                         (t.cantidad - previo - 1) * sizeof(Registro));
+            t.cantidad--;
+        }
+
+        int pos = buscarPuntaje(t, nuevo.puntaje);
+        if (pos >= TOP_N) return false;
+        int mover = (t.cantidad < TOP_N ? t.cantidad : TOP_N - 1) - pos;
+        if (mover > 0) {
+            std::memmove(&t.registros[pos + 1], &t.registros[pos], mover * sizeof(Registro));
+        }
+        t.registros[pos] = nuevo;
+        if (t.cantidad < TOP_N) t.cantidad++;
+        reconstruirIndice(t);
+        return true;
+    }
+
+    void confirmar(int origen, const Ranura& nueva) {
+        int destino = 1 - origen;
+        Ranura& r = mapa->ranuras[destino];
+        std::memcpy(&r.tablas, &nueva.tablas, sizeof(r.tablas));
+        r.secuencia = nueva.secuencia;
+        r.checksum = calcularChecksum(r);
+        msync(mapa, sizeof(Archivo), MS_SYNC);
+    }
+
+    // Con mutexTabla tomado: dos hilos que abren a la vez no se pisan
+    bool abrirSinLock() {
+        if (mapa != nullptr) return true;
+        descriptor = ::open(ruta.c_str(), O_RDWR | O_CREAT, 0644);
+        if (descriptor < 0) return false;
+
+        flock(descriptor, LOCK_EX);
+        // Sin el tamaño no se sabe si hay que crecerlo, y proyectar un archivo
+        // corto daría SIGBUS al primer acceso: fstat fallido = error al abrir
+        struct stat info;
+        bool error = fstat(descriptor, &info) != 0;
+        if (!error && info.st_size < static_cast<off_t>(sizeof(Archivo))) {
+            error = ftruncate(descriptor, sizeof(Archivo)) != 0;
+        }
+        if (error) {
+            flock(descriptor, LOCK_UN);
+            ::close(descriptor);
+            descriptor = -1;
+            return false;
+        }
+
+        void* p = mmap(nullptr, sizeof(Archivo), PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+        if (p == MAP_FAILED) {
+            flock(descriptor, LOCK_UN);
+            ::close(descriptor);
+            descriptor = -1;
+            return false;
+        }
+        mapa = static_cast<Archivo*>(p);
+
+        if (std::memcmp(mapa->magico, "CJREC01", 8) != 0) {
+            std::memset(mapa, 0, sizeof(Archivo));
+            std::memcpy(mapa->magico, "CJREC01", 8);
+            for (int i = 0; i < 2; i++) {
+                mapa->ranuras[i].checksum = calcularChecksum(mapa->ranuras[i]);
+            }
+            msync(mapa, sizeof(Archivo), MS_SYNC);
+        }
+        flock(descriptor, LOCK_UN);
+        return true;
+    }
+
+public:
+    explicit TablaRecords(const std::string& rutaArchivo = "records.dat")
+        : ruta(rutaArchivo), descriptor(-1), mapa(nullptr) {}
+
+    ~TablaRecords() { cerrar(); }
+
+    TablaRecords(const TablaRecords&) = delete;
+    TablaRecords& operator=(const TablaRecords&) = delete;
+
+    bool abrir() {
+        std::lock_guard<std::mutex> lock(mutexTabla);
+        return abrirSinLock();
+    }
+
+    void cerrar() {
+        std::lock_guard<std::mutex> lock(mutexTabla);
+        if (mapa != nullptr) {
+            munmap(mapa, sizeof(Archivo));
+            mapa = nullptr;
+        }
+        if (descriptor >= 0) {
+            ::close(descriptor);
+            descriptor = -1;
+        }
+    }
+
+    // Registra una partida en la tabla histórica y en la de su nivel.
+    // Devuelve true si entró en alguna de las dos.
+    bool registrar(const std::string& nombre, int puntaje, int nivel) {
+        Registro nuevo;
+        std::memset(&nuevo, 0, sizeof(nuevo));
+        copiarTextoUtf8(nuevo.nombre, TAM_NOMBRE, nombre);
+        nuevo.puntaje = puntaje;
+        nuevo.nivel = nivel;
+
+        // mutex entre hilos del proceso, flock entre procesos
+        std::lock_guard<std::mutex> lock(mutexTabla);
+        if (!abrirSinLock()) return false;
+        flock(descriptor, LOCK_EX);
+
+        int origen = ranuraVigente();
+        Ranura trabajo = mapa->ranuras[origen];
+        bool entro = insertarEn(trabajo.tablas[0], nuevo);
+        entro = insertarEn(trabajo.tablas[indiceTabla(nivel)], nuevo) || entro;
+        if (entro) {
+            trabajo.secuencia = mapa->ranuras[origen].secuencia + 1;
+            confirmar(origen, trabajo);
+        }
+
+        flock(descriptor, LOCK_UN);
+        return entro;
+    }
+
+    // Mejor puntaje registrado de un jugador (histórico si nivel == 0), o -1
+    int mejorPuntaje(const std::string& nombre, int nivel = 0) {
+        char clave[TAM_NOMBRE];
+        copiarTextoUtf8(clave, TAM_NOMBRE, nombre);
+
+        std::lock_guard<std::mutex> lock(mutexTabla);
+        if (!abrirSinLock()) return -1;
+        flock(descriptor, LOCK_SH);
+        const Tabla& t = mapa->ranuras[ranuraVigente()].tablas[nivel == 0 ? 0 : indiceTabla(nivel)];
+        int pos = buscarNombre(t, clave);
+        int puntaje = -1;
+        if (pos < t.cantidad &&
+            std::strncmp(t.registros[t.porNombre[pos]].nombre, clave, TAM_NOMBRE) == 0) {
+            puntaje = t.registros[t.porNombre[pos]].puntaje;
+        }
+        flock(descriptor, LOCK_UN);
+        return puntaje;
+    }
+
+    std::vector<Registro> obtenerTop(int nivel = 0) {
+        std::vector<Registro> resultado;
+        std::lock_guard<std::mutex> lock(mutexTabla);
+        if (!abrirSinLock()) return resultado;
+        flock(descriptor, LOCK_SH);
+        const Tabla& t = mapa->ranuras[ranuraVigente()].tablas[nivel == 0 ? 0 : indiceTabla(nivel)];
+        resultado.assign(t.registros, t.registros + t.cantidad);
+        flock(descriptor, LOCK_UN);
+        return resultado;
+    }
+
+    int recordHistorico() {
+        std::vector<Registro> top = obtenerTop(0);
+        return top.empty() ? 0 : top[0].puntaje;
+    }
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef TEXTOUTF8_H
+#define TEXTOUTF8_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+// Copia `texto` en un campo de tamaño fijo terminado en '\0' (capacidad - 1
+// bytes como mucho). Si no cabe, corta en un límite de carácter UTF-8: nunca
+// deja la primera mitad de una secuencia multibyte. El resto queda a cero.
+inline void copiarTextoUtf8(char* destino, size_t capacidad, const std::string& texto) {
+    std::memset(destino, 0, capacidad);
+    if (capacidad == 0) return;
+    size_t n = texto.size() < capacidad - 1 ? texto.size() : capacidad - 1;
+    if (n < texto.size()) {
+        // Retrocede mientras el primer byte que queda fuera sea de continuación (10xxxxxx)
+        while (n > 0 && (static_cast<unsigned char>(texto[n]) & 0xC0) == 0x80) n--;
+    }
+    std::memcpy(destino, texto.data(), n);
+}
+
+// Longitud de un campo de tamaño fijo que puede ocuparlo entero sin '\0'
+inline std::string leerTextoFijo(const char* origen, size_t capacidad) {
+    size_t n = 0;
+    while (n < capacidad && origen[n] != '\0') n++;
+    return std::string(origen, n);
+}
+
+#endif
@@ -1,88 +1,35 @@
 #include "ControlJuego.h"
-#include <cstdlib>
+#include "GestorSesiones.h"
+#include "Entidades.h"
+#include "IndiceEspacial.h"
+#include <chrono>
+#include <cmath>
 #include <ctime>
+#include <vector>
 
 class Jugador {
 private:
     std::string nombre;
+    Posicion posicion;
     ControlJuego* control;
 public:
     Jugador(const std::string& n) : nombre(n), control(ControlJuego::obtenerInstancia()) {
+        control->setJugadorActual(nombre);
         std::cout << "\n👤 Jugador '" << nombre << "' conectado al juego\n";
     }
     
     std::string getNombre() const { return nombre; }
     ControlJuego* getControl() { return control; }
     
+    const Posicion& getPosicion() const { return posicion; }
+    void moverA(Posicion p) { posicion = p; }
+    
     void recibirDano() {
         std::cout << "   💥 " << nombre << " recibió daño\n";
         control->perderVida();
     }
 };
 
-class Enemigo {
-private:
-    static int contador;
-    std::string nombre;
-    int vida;
-    ControlJuego* control;
-    int puntosOtorgados;
-public:
-    Enemigo(const std::string& tipo = "Básico") 
-        : vida(100), control(ControlJuego::obtenerInstancia()) {
-        contador++;
-        nombre = tipo + " #" + std::to_string(contador);
-        puntosOtorgados = (tipo == "Básico") ? 50 : 150;
-    }
-    
-    std::string getNombre() const { return nombre; }
-    
-    void recibirDano() {
-        vida -= (rand() % 31 + 30);
-        std::cout << "   💥 " << nombre << " recibió daño (Vida: " << (vida > 0 ? vida : 0) << ")\n";
-        
-        if (vida <= 0) {
-            eliminar();
-        }
-    }
-    
-    void eliminar() {
-        std::cout << "   ☠️  " << nombre << " eliminado\n";
-        control->sumarPuntos(puntosOtorgados);
-        control->registrarEnemigoEliminado();
-    }
-};
-
-int Enemigo::contador = 0;
-
-class Item {
-private:
-    std::string nombre;
-    std::string tipo;
-    ControlJuego* control;
-public:
-    Item(const std::string& n, const std::string& t) 
-        : nombre(n), tipo(t), control(ControlJuego::obtenerInstancia()) {}
-    
-    std::string getNombre() const { return nombre; }
-    
-    void aplicarEfecto() {
-        control->registrarItemRecolectado();
-        
-        if (tipo == "puntos") {
-            int puntos = rand() % 201 + 100;
-            control->sumarPuntos(puntos);
-            std::cout << "   ⭐ Ganaste " << puntos << " puntos\n";
-        } else if (tipo == "vida") {
-            control->ganarVida();
-        } else if (tipo == "poder") {
-            int puntos = 500;
-            control->sumarPuntos(puntos);
-            std::cout << "   ⚡ ¡Poder especial activado! +" << puntos << " puntos\n";
-        }
-    }
-};
-
 class InterfazJuego {
 private:
     ControlJuego* control;
@@ -99,14 +46,16 @@ public:
 };
 
 int main() {
-    srand(time(0));
-    
     std::cout << std::string(60, '=') << "\n";
     std::cout << "EJERCICIO 04: CONTROL DE JUEGO CON SINGLETON\n";
     std::cout << std::string(60, '=') << "\n";
     
     ControlJuego* control1 = ControlJuego::obtenerInstancia();
     ControlJuego* control2 = ControlJuego::obtenerInstancia();
+    control1->sembrar(static_cast<uint64_t>(time(0)));
+    
+    TablaRecords tablaRecords("records.dat");
+    control1->conectarTablaRecords(&tablaRecords);
     std::cout << "\n✅ Misma instancia de control: " << (control1 == control2 ? "true" : "false") << "\n";
     
     InterfazJuego interfaz;
@@ -119,48 +68,59 @@ int main() {
               << (interfaz.getControl() == jugador.getControl() && 
                   jugador.getControl() == control1 ? "true" : "false") << "\n";
     
+    DiarioEventos diario;
+    control1->iniciarGrabacion(&diario);
     control1->iniciarJuego();
     
     std::cout << "\n" << std::string(60, '=') << "\n";
     std::cout << "🎮 NIVEL 1\n";
     std::cout << std::string(60, '=') << "\n";
     
-    Enemigo enemigo1("Básico");
-    Enemigo enemigo2("Básico");
+    PoolEnemigos enemigos;
+    PoolItems items;
     
-    std::cout << "\n⚔️  " << jugador.getNombre() << " ataca a " << enemigo1.getNombre() << "\n";
-    if (rand() % 10 > 2) {
-        enemigo1.recibirDano();
+    Manejador enemigo1 = enemigos.crear("Básico");
+    Manejador enemigo2 = enemigos.crear("Básico");
+    
+    std::cout << "\n⚔️  " << jugador.getNombre() << " ataca a " << enemigos.obtener(enemigo1)->getNombre() << "\n";
+    if (control1->aleatorio(10) > 2) {
+        enemigos.obtener(enemigo1)->recibirDano();
     } else {
         std::cout << "   ❌ ¡Falló el ataque!\n";
         jugador.recibirDano();
     }
     
-    std::cout << "\n⚔️  " << jugador.getNombre() << " ataca a " << enemigo2.getNombre() << "\n";
-    enemigo2.recibirDano();
+    std::cout << "\n⚔️  " << jugador.getNombre() << " ataca a " << enemigos.obtener(enemigo2)->getNombre() << "\n";
+    enemigos.obtener(enemigo2)->recibirDano();
     
-    Item item1("Moneda de oro", "puntos");
-    std::cout << "\n🎁 " << jugador.getNombre() << " recolecta: " << item1.getNombre() << "\n";
-    item1.aplicarEfecto();
+    Manejador item1 = items.crear("Moneda de oro", "puntos");
+    std::cout << "\n🎁 " << jugador.getNombre() << " recolecta: " << items.obtener(item1)->getNombre() << "\n";
+    items.obtener(item1)->aplicarEfecto();
     
     interfaz.actualizarPantalla();
     control1->subirNivel();
     
+    // Fin del nivel: se despachan las entidades y sus ranuras quedan libres
+    enemigos.vaciar();
+    items.vaciar();
+    std::cout << "\n♻️  Entidades del nivel 1 devueltas al pool (manejador antiguo válido: "
+              << (enemigos.obtener(enemigo1) != nullptr ? "true" : "false") << ")\n";
+    
     std::cout << "\n" << std::string(60, '=') << "\n";
     std::cout << "🎮 NIVEL 2\n";
     std::cout << std::string(60, '=') << "\n";
     
-    Enemigo enemigo3("Élite");
-    std::cout << "\n⚔️  " << jugador.getNombre() << " ataca a " << enemigo3.getNombre() << "\n";
-    enemigo3.recibirDano();
+    Manejador enemigo3 = enemigos.crear("Élite");
+    std::cout << "\n⚔️  " << jugador.getNombre() << " ataca a " << enemigos.obtener(enemigo3)->getNombre() << "\n";
+    enemigos.obtener(enemigo3)->recibirDano();
     
-    Item item2("Corazón", "vida");
-    std::cout << "\n🎁 " << jugador.getNombre() << " recolecta: " << item2.getNombre() << "\n";
-    item2.aplicarEfecto();
+    Manejador item2 = items.crear("Corazón", "vida");
+    std::cout << "\n🎁 " << jugador.getNombre() << " recolecta: " << items.obtener(item2)->getNombre() << "\n";
+    items.obtener(item2)->aplicarEfecto();
     
-    Item item3("Estrella", "poder");
-    std::cout << "\n🎁 " << jugador.getNombre() << " recolecta: " << item3.getNombre() << "\n";
-    item3.aplicarEfecto();
+    Manejador item3 = items.crear("Estrella", "poder");
+    std::cout << "\n🎁 " << jugador.getNombre() << " recolecta: " << items.obtener(item3)->getNombre() << "\n";
+    items.obtener(item3)->aplicarEfecto();
     
     interfaz.actualizarPantalla();
     control1->finalizarJuego();
@@ -170,12 +130,158 @@ int main() {
     std::cout << std::string(60, '=') << "\n";
     control2->iniciarJuego();
     
-    Enemigo enemigo4("Básico");
-    std::cout << "\n⚔️  " << jugador.getNombre() << " ataca a " << enemigo4.getNombre() << "\n";
-    enemigo4.recibirDano();
+    Manejador enemigo4 = enemigos.crear("Básico");
+    std::cout << "\n⚔️  " << jugador.getNombre() << " ataca a " << enemigos.obtener(enemigo4)->getNombre() << "\n";
+    enemigos.obtener(enemigo4)->recibirDano();
+    
+    // Oleada con posiciones: los ataques en área y la recogida de items
+    // consultan el índice espacial en lugar de recorrer todas las entidades
+    IndiceEspacial indiceEnemigos(4.0f);
+    IndiceEspacial indiceItems(4.0f);
+    jugador.moverA(Posicion(50, 50));
+    const int enemigosOleada = 200;
+    for (int i = 0; i < enemigosOleada; i++) {
+        enemigos.crear(i % 10 == 0 ? "Élite" : "Básico",
+                       Posicion(static_cast<float>(control2->aleatorio(100)), static_cast<float>(control2->aleatorio(100))));
+    }
+    for (int i = 0; i < 30; i++) {
+        items.crear("Moneda de oro", "puntos",
+                    Posicion(static_cast<float>(30 + control2->aleatorio(40)), static_cast<float>(30 + control2->aleatorio(40))));
+    }
+    items.crear("Estrella", "poder", Posicion(52, 49));
+    indiceEnemigos.sincronizar(enemigos);
+    indiceItems.sincronizar(items);
+    
+    std::cout << "\n🌀 " << jugador.getNombre() << " lanza un ataque en área (radio 8) con "
+              << enemigos.getActivos() << " enemigos en el nivel\n";
+    // Los derribados salen del pool; sincronizar() los retira del índice
+    auto golpear = [&](Manejador h, Posicion) {
+        Enemigo* e = enemigos.obtener(h);
+        e->recibirDano();
+        if (!e->estaVivo()) enemigos.destruir(h);
+    };
+    indiceEnemigos.enRadio(jugador.getPosicion(), 8.0f, golpear);
+    indiceEnemigos.sincronizar(enemigos);
+    std::cout << "\n💀 Quedan " << enemigos.getActivos() << " enemigos en el nivel ("
+              << indiceEnemigos.getNumEntradas() << " en el índice)\n";
+    
+    // Cada tick los enemigos avanzan hacia el jugador; solo los que cruzan de
+    // celda cambian de cubeta en el índice
+    for (int tick = 0; tick < 10; tick++) {
+        enemigos.paraCada([&](Enemigo& e) {
+            Posicion p = e.getPosicion();
+            float dx = jugador.getPosicion().x - p.x, dy = jugador.getPosicion().y - p.y;
+            float distancia = std::sqrt(dx * dx + dy * dy);
+            if (distancia > 1.0f) e.moverA(Posicion(p.x + dx / distancia, p.y + dy / distancia));
+        });
+        indiceEnemigos.sincronizar(enemigos);
+    }
+    std::cout << "\n🚶 10 ticks de avance: " << indiceEnemigos.getCambiosDeCelda()
+              << " cambios de celda en el índice\n";
+    std::cout << "\n🌀 Segundo ataque en área (radio 8)\n";
+    indiceEnemigos.enRadio(jugador.getPosicion(), 8.0f, golpear);
+    indiceEnemigos.sincronizar(enemigos);
+    std::cout << "\n💀 Quedan " << enemigos.getActivos() << " enemigos en el nivel ("
+              << indiceEnemigos.getNumEntradas() << " en el índice)\n";
+    
+    std::vector<Manejador> alAlcance;
+    Posicion p = jugador.getPosicion();
+    indiceItems.enCaja(Posicion(p.x - 4, p.y - 4), Posicion(p.x + 4, p.y + 4),
+                       [&](Manejador h, Posicion) { alAlcance.push_back(h); });
+    for (size_t i = 0; i < alAlcance.size(); i++) {
+        std::cout << "\n🎁 " << jugador.getNombre() << " recoge al pasar: " << items.obtener(alAlcance[i])->getNombre() << "\n";
+        items.obtener(alAlcance[i])->aplicarEfecto();
+        items.destruir(alAlcance[i]);
+    }
+    indiceItems.sincronizar(items);
     
     interfaz.actualizarPantalla();
     control2->finalizarJuego();
+    control2->detenerGrabacion();
+    
+    std::cout << "\n" << std::string(60, '=') << "\n";
+    std::cout << "💾 INSTANTÁNEA Y REPRODUCCIÓN\n";
+    std::cout << std::string(60, '=') << "\n";
+    
+    // El bucle del juego solo publica; el guardado lee una copia coherente
+    DobleBufferEstado publicado;
+    publicado.publicar(control1->tomarInstantanea());
+    EstadoJuego final = publicado.leer();
+    std::cout << "Guardando partida (" << Instantanea::TAMANO << " bytes): "
+              << (Instantanea::guardar(final, "partida.sav") ? "ok" : "error") << "\n";
+    std::cout << "Guardando diario (" << diario.tamano() << " eventos): "
+              << (diario.guardar("partida.diario") ? "ok" : "error") << "\n";
+    
+    DiarioEventos diarioCargado;
+    diarioCargado.cargar("partida.diario");
+    
+    const int repeticiones = 100000;
+    auto inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeticiones; i++) {
+        control1->reproducir(diarioCargado);
+    }
+    auto fin = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(fin - inicio).count();
+    
+    EstadoJuego reproducido = control1->tomarInstantanea();
+    // Todo el EstadoJuego: generador aleatorio y jugador incluidos
+    bool identico = reproducido == final;
+    std::cout << "Reproducción x" << repeticiones << " en " << ms << " ms\n";
+    std::cout << "✅ Estado reproducido idéntico al original: " << (identico ? "true" : "false") << "\n";
+    
+    control1->cargarPartida("partida.sav");
+    control1->mostrarEstado();
+    
+    std::cout << "\n📋 TABLA DE RÉCORDS (persistente en records.dat)\n";
+    std::vector<TablaRecords::Registro> top = tablaRecords.obtenerTop();
+    for (size_t i = 0; i < top.size(); i++) {
+        std::cout << "   " << (i + 1) << ". " << top[i].nombre << " - "
+                  << top[i].puntaje << " pts (nivel " << top[i].nivel << ")\n";
+    }
+    std::cout << "   Mejor marca de " << jugador.getNombre() << ": "
+              << tablaRecords.mejorPuntaje(jugador.getNombre()) << "\n";
+    
+    std::cout << "\n" << std::string(60, '=') << "\n";
+    std::cout << "🌐 MÚLTIPLES SESIONES EN UN PROCESO\n";
+    std::cout << std::string(60, '=') << "\n";
+    
+    {
+        GestorSesiones gestor;
+        const int numSesiones = 10000;
+        const int accionesPorSesion = 100;
+        
+        auto inicioSesiones = std::chrono::steady_clock::now();
+        std::vector<std::future<IdSesion> > pendientes;
+        for (int i = 0; i < numSesiones; i++) pendientes.push_back(gestor.crearSesion());
+        std::vector<IdSesion> sesiones;
+        for (size_t i = 0; i < pendientes.size(); i++) sesiones.push_back(pendientes[i].get());
+        
+        for (size_t i = 0; i < sesiones.size(); i++) {
+            gestor.enviar(sesiones[i], [](ControlJuego& c) { c.iniciarJuego(); });
+        }
+        for (int a = 0; a < accionesPorSesion; a++) {
+            for (size_t i = 0; i < sesiones.size(); i++) {
+                gestor.enviar(sesiones[i], [](ControlJuego& c) {
+                    c.sumarPuntos(c.aleatorio(100));
+                    c.registrarEnemigoEliminado();
+                });
+            }
+        }
+        EstadoJuego muestra = gestor.consultar(sesiones[0]).get();
+        for (size_t i = 0; i < sesiones.size(); i++) gestor.cerrarSesion(sesiones[i]);
+        gestor.detener();
+        auto finSesiones = std::chrono::steady_clock::now();
+        double msSesiones = std::chrono::duration<double, std::milli>(finSesiones - inicioSesiones).count();
+        
+        std::cout << "Fragmentos (hilos): " << gestor.getNumFragmentos() << "\n";
+        std::cout << "Sesiones: " << numSesiones << ", acciones: "
+                  << static_cast<long>(numSesiones) * accionesPorSesion << " en " << msSesiones << " ms\n";
+        std::cout << "Sesión de muestra: " << muestra.enemigosEliminados << " enemigos, "
+                  << muestra.puntaje << " puntos\n";
+        std::cout << "✅ Sesión por defecto sigue siendo el singleton: "
+                  << (gestor.consultar(GestorSesiones::SESION_POR_DEFECTO).get().puntuacionMaxima ==
+                      control1->tomarInstantanea().puntuacionMaxima ? "true" : "false") << "\n";
+    }
     
     std::cout << "\n" << std::string(60, '=') << "\n";
     std::cout << "CONCLUSIÓN\n";
@@ -185,6 +291,10 @@ int main() {
     std::cout << "✅ El ControlJuego mantiene la consistencia global\n";
     std::cout << "✅ El patrón Singleton facilita la comunicación entre componentes\n";
     
+    enemigos.vaciar();
+    items.vaciar();
+    TablaNombres::destruirInstancia();
     ControlJuego::destruirInstancia();
+    RegistroMetricas::destruirInstancia();
     return 0;
 }
@@ -0,0 +1,222 @@
+#ifndef BUFFERMAPEADO_H
+#define BUFFERMAPEADO_H
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ---------------------------------------------------------------------------
+// Buffer de log sobre una ventana del archivo mapeada con MAP_SHARED.
+//
+// Escribir una línea es un memcpy a la page cache: no hay write() por línea
+// y, si el proceso muere, lo copiado ya pertenece al kernel y llega al archivo.
+// El archivo se agranda por ventanas, así que tras una caída puede acabar en
+// bytes nulos; abrir() los recorta.
+//
+// El manejador de SIGSEGV/SIGABRT solo usa pwrite, ftruncate y
+// sigaction/raise (async-signal-safe): escribe una marca de cierre tras la
+// última línea completa, recorta el archivo y deja actuar al manejador previo.
+// No toca la ventana: otro hilo puede estar cambiándola y desmapeando la
+// anterior, y la page cache es la misma para pwrite y para el mapeo.
+// El llamador serializa escribir()/cerrar() (LoggerThreadSafe usa mutexEscritura).
+//
+// Cada proceso escribe en su propio `escrito` y cerrar() recorta a él, así
+// que dos procesos no pueden mapear el mismo archivo: abrir() toma un flock
+// exclusivo que dura lo que dure el mapeo y falla con `ocupado` si otro
+// proceso ya lo tiene. Si una ventana nueva no se puede mapear, se recorta
+// el relleno y las líneas siguientes se escriben con pwrite() justo detrás de
+// la última, sin soltar el flock.
+// ---------------------------------------------------------------------------
+class BufferMapeado {
+private:
+    static std::atomic<BufferMapeado*> activo;
+    static struct sigaction anteriorSegv;
+    static struct sigaction anteriorAbrt;
+
+    int fd;
+    std::atomic<size_t> tamVentana;
+    std::atomic<char*> base;                // nullptr mientras se cambia de ventana
+    std::atomic<size_t> inicioVentana;      // desplazamiento de `base` en el archivo
+    std::atomic<size_t> escrito;            // fin de la última línea completa
+    bool ocupado;                           // otro proceso tenía el archivo mapeado
+
+    static size_t tamPagina() { return static_cast<size_t>(sysconf(_SC_PAGESIZE)); }
+
+    // Último byte no nulo del archivo (lo que sobra es relleno de una caída)
+    static size_t finReal(int descriptor, size_t tam) {
+        char bloque[4096];
+        while (tam > 0) {
+            size_t n = tam < sizeof(bloque) ? tam : sizeof(bloque);
+            if (pread(descriptor, bloque, n, static_cast<off_t>(tam - n)) != static_cast<ssize_t>(n)) break;
+            for (size_t i = n; i > 0; i--) {
+                if (bloque[i - 1] != '\0') return tam - n + i;
+            }
+            tam -= n;
+        }
+        return tam;
+    }
+
+    // Mapea una ventana que empieza en la página de `escrito` y cabe `necesario`
+    bool mapearVentana(size_t necesario) {
+        size_t pagina = tamPagina();
+        size_t fin = escrito.load(std::memory_order_relaxed);
+        size_t inicio = fin / pagina * pagina;
+        size_t tam = tamVentana.load(std::memory_order_relaxed);
+        if (fin - inicio + necesario > tam) tam = (fin - inicio + necesario + pagina - 1) / pagina * pagina;
+
+        char* anterior = base.exchange(nullptr);
+        if (anterior != nullptr) munmap(anterior, tamVentana.load(std::memory_order_relaxed));
+        void* region = MAP_FAILED;
+        if (ftruncate(fd, static_cast<off_t>(inicio + tam)) == 0) {
+            region = mmap(nullptr, tam, PROT_READ | PROT_WRITE, MAP_SHARED, fd, static_cast<off_t>(inicio));
+        }
+        if (region == MAP_FAILED) {
+            // Sin relleno detrás de la última línea: lo siguiente va con pwrite()
+            if (ftruncate(fd, static_cast<off_t>(fin)) != 0) {}
+            return false;
+        }
+        tamVentana.store(tam, std::memory_order_relaxed);
+        inicioVentana.store(inicio, std::memory_order_relaxed);
+        base.store(static_cast<char*>(region), std::memory_order_release);
+        return true;
+    }
+
+    // Sin ventana (no se pudo mapear la siguiente): escritura directa
+    bool escribirDirecto(const char* datos, size_t n) {
+        size_t fin = escrito.load(std::memory_order_relaxed);
+        size_t hecho = 0;
+        while (hecho < n) {
+            ssize_t r = pwrite(fd, datos + hecho, n - hecho, static_cast<off_t>(fin + hecho));
+            if (r <= 0) {
+                if (ftruncate(fd, static_cast<off_t>(fin)) != 0) {}
+                return false;
+            }
+            hecho += static_cast<size_t>(r);
+        }
+        escrito.store(fin + n, std::memory_order_release);
+        return true;
+    }
+
+    static void manejarCaida(int senal) {
+        int errnoGuardado = errno;
+        BufferMapeado* buffer = activo.load(std::memory_order_acquire);
+        if (buffer != nullptr) {
+            char marca[96];
+            const char* texto = "*** Señal ";
+            size_t n = 0;
+            while (texto[n] != '\0') { marca[n] = texto[n]; n++; }
+            char digitos[8];
+            size_t d = 0;
+            for (int v = senal; v > 0 && d < sizeof(digitos); v /= 10) digitos[d++] = static_cast<char>('0' + v % 10);
+            while (d > 0) marca[n++] = digitos[--d];
+            const char* resto = ": fin del registro ***\n";
+            for (size_t i = 0; resto[i] != '\0'; i++) marca[n++] = resto[i];
+
+            size_t fin = buffer->escrito.load(std::memory_order_acquire);
+            if (pwrite(buffer->fd, marca, n, static_cast<off_t>(fin)) == static_cast<ssize_t>(n)) fin += n;
+            if (ftruncate(buffer->fd, static_cast<off_t>(fin)) != 0) {}
+        }
+        sigaction(senal, senal == SIGSEGV ? &anteriorSegv : &anteriorAbrt, nullptr);
+        errno = errnoGuardado;
+        raise(senal);
+    }
+
+public:
+    explicit BufferMapeado(size_t ventana = 1 << 20)
+        : fd(-1), tamVentana(ventana), base(nullptr), inicioVentana(0), escrito(0), ocupado(false) {}
+
+    BufferMapeado(const BufferMapeado&) = delete;
+    BufferMapeado& operator=(const BufferMapeado&) = delete;
+
+    ~BufferMapeado() { cerrar(); }
+
+    // Abre para añadir; false si no se puede mapear (el llamador escribe sin
+    // buffer) o si otro proceso lo tiene mapeado (getOcupado())
+    bool abrir(const std::string& ruta) {
+        ocupado = false;
+        fd = ::open(ruta.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) return false;
+        if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+            ocupado = errno == EWOULDBLOCK;
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            // Aún no se sabe dónde acaba: no se recorta nada
+            flock(fd, LOCK_UN);
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+        escrito.store(finReal(fd, static_cast<size_t>(info.st_size)), std::memory_order_relaxed);
+        if (!mapearVentana(0)) {
+            cerrar();
+            return false;
+        }
+        activo.store(this, std::memory_order_release);
+        return true;
+    }
+
+    bool abierto() const { return base.load(std::memory_order_relaxed) != nullptr; }
+    bool getOcupado() const { return ocupado; }
+
+    bool escribir(const char* datos, size_t n) {
+        if (fd < 0) return false;
+        char* region = base.load(std::memory_order_relaxed);
+        if (region == nullptr) return escribirDirecto(datos, n);
+        size_t fin = escrito.load(std::memory_order_relaxed);
+        size_t inicio = inicioVentana.load(std::memory_order_relaxed);
+        if (fin - inicio + n > tamVentana.load(std::memory_order_relaxed)) {
+            if (!mapearVentana(n)) return escribirDirecto(datos, n);
+            region = base.load(std::memory_order_relaxed);
+            inicio = inicioVentana.load(std::memory_order_relaxed);
+        }
+        std::memcpy(region + (fin - inicio), datos, n);
+        // Publicar el nuevo fin solo con la línea completa
+        escrito.store(fin + n, std::memory_order_release);
+        return true;
+    }
+
+    // Libera la ventana, deja el archivo con su tamaño real y suelta el flock
+    void cerrar() {
+        BufferMapeado* yo = this;
+        activo.compare_exchange_strong(yo, nullptr);
+        char* region = base.exchange(nullptr);
+        if (region != nullptr) munmap(region, tamVentana.load(std::memory_order_relaxed));
+        if (fd >= 0) {
+            if (ftruncate(fd, static_cast<off_t>(escrito.load())) != 0) {}
+            flock(fd, LOCK_UN);
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    size_t getBytesEscritos() const { return escrito.load(std::memory_order_relaxed); }
+
+    // Idempotente; el manejador actúa sobre el último buffer abierto
+    static void instalarManejadorCaidas() {
+        static std::atomic<bool> instalado(false);
+        if (instalado.exchange(true)) return;
+        struct sigaction accion;
+        std::memset(&accion, 0, sizeof(accion));
+        accion.sa_handler = &BufferMapeado::manejarCaida;
+        sigemptyset(&accion.sa_mask);
+        sigaction(SIGSEGV, &accion, &anteriorSegv);
+        sigaction(SIGABRT, &accion, &anteriorAbrt);
+    }
+};
+
+std::atomic<BufferMapeado*> BufferMapeado::activo(nullptr);
+struct sigaction BufferMapeado::anteriorSegv;
+struct sigaction BufferMapeado::anteriorAbrt;
+
+#endif
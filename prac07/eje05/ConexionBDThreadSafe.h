@@ -1,94 +1,148 @@
 #ifndef CONEXIONBDTHREADSAFE_H
 #define CONEXIONBDTHREADSAFE_H
 
+#include <atomic>
 #include <string>
 #include <iostream>
+#include <memory>
 #include <mutex>
-#include <thread>
-#include <chrono>
+#include "../comun/ModeloLatencia.h"
+#include "../comun/Traza.h"
+#include "MutexPerfilado.h"
+#include "../comun/Ejecutor.h"
+#include "../comun/Metricas.h"
 
 class ConexionBDThreadSafe {
 private:
-    static ConexionBDThreadSafe* instancia;
-    static std::mutex mutexInstancia;
-    std::mutex mutexConexion;
-    std::mutex mutexContador;
+    static std::atomic<ConexionBDThreadSafe*> instancia;
+    static MutexPerfilado mutexInstancia;
+    MutexPerfilado mutexConexion;
+    MutexPerfilado mutexContador;
     
-    bool conectado;
+    std::atomic<bool> conectado;
     int consultasEjecutadas;
     bool inicializado;
+    InyectorLatencia latenciaConectar;
+    InyectorLatencia latenciaConsulta;
+    Contador metricaConsultas;
+    Histograma metricaLatencia;
     
-    ConexionBDThreadSafe() : conectado(false), consultasEjecutadas(0), 
-                             inicializado(false) {}
+    // El contador se protege con giro adaptativo: su sección crítica es un incremento
+    ConexionBDThreadSafe() : mutexConexion("ConexionBDThreadSafe::mutexConexion"),
+                             mutexContador("ConexionBDThreadSafe::mutexContador", true),
+                             conectado(false), consultasEjecutadas(0), 
+                             inicializado(false),
+                             latenciaConectar("CONECTAR", "fija:500"),
+                             latenciaConsulta("CONSULTA", "fija:200"),
+                             metricaConsultas("prac07_bd_consultas_total{clase=\"ConexionBDThreadSafe\"}",
+                                              "Consultas completadas por la base de datos"),
+                             metricaLatencia("prac07_bd_consulta_segundos{clase=\"ConexionBDThreadSafe\"}",
+                                             "Duración de ejecutarConsulta, latencia del backend incluida") {}
     
     ConexionBDThreadSafe(const ConexionBDThreadSafe&) = delete;
     ConexionBDThreadSafe& operator=(const ConexionBDThreadSafe&) = delete;
 
 public:
     static ConexionBDThreadSafe* obtenerInstancia() {
-        // Double-checked locking
-        if (instancia == nullptr) {
-            std::lock_guard<std::mutex> lock(mutexInstancia);
-            if (instancia == nullptr) {
+        // Double-checked locking (acquire/release sobre el puntero atómico)
+        ConexionBDThreadSafe* actual = instancia.load(std::memory_order_acquire);
+        if (actual == nullptr) {
+            std::lock_guard<MutexPerfilado> lock(mutexInstancia);
+            actual = instancia.load(std::memory_order_relaxed);
+            if (actual == nullptr) {
                 std::cout << "🔧 Creando nueva instancia de ConexionBDThreadSafe...\n";
-                instancia = new ConexionBDThreadSafe();
-                instancia->inicializado = true;
+                actual = new ConexionBDThreadSafe();
+                actual->inicializado = true;
+                instancia.store(actual, std::memory_order_release);
                 std::cout << "✅ Instancia de ConexionBDThreadSafe inicializada\n";
             }
         }
-        return instancia;
+        return actual;
     }
     
     bool conectar() {
-        std::lock_guard<std::mutex> lock(mutexConexion);
+        TRAZA_SPAN("ConexionBDThreadSafe::conectar", "bd");
+        LockTrazado<MutexPerfilado> lock(mutexConexion, "espera mutexConexion");
         if (conectado) {
             std::cout << "⚠️  La conexión ya está activa\n";
             return false;
         }
         
         std::cout << "🔌 Estableciendo conexión...\n";
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        {
+            TRAZA_SPAN("backend conectar", "backend");
+            latenciaConectar.aplicar();
+        }
         conectado = true;
         std::cout << "✅ Conexión establecida\n";
         return true;
     }
     
     std::string ejecutarConsulta(const std::string& consulta) {
+        TRAZA_SPAN("ConexionBDThreadSafe::ejecutarConsulta", "bd");
+        CronometroMetrica cronometro(metricaLatencia);
         if (!conectado) {
             std::cout << "❌ No hay conexión activa\n";
             return "";
         }
         
         std::cout << "📊 Ejecutando: " << consulta << "\n";
-        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        {
+            TRAZA_SPAN("backend consulta", "backend");
+            latenciaConsulta.aplicar();
+        }
         
         // Incrementar contador de forma thread-safe
         int numConsulta;
         {
-            std::lock_guard<std::mutex> lock(mutexContador);
+            LockTrazado<MutexPerfilado> lock(mutexContador, "espera mutexContador");
             consultasEjecutadas++;
             numConsulta = consultasEjecutadas;
         }
+        metricaConsultas.incrementar();
         
         std::cout << "✅ Consulta #" << numConsulta << " completada\n";
         return "Resultado #" + std::to_string(numConsulta);
     }
     
+    // Ejecuta la consulta en el Ejecutor compartido en lugar de un hilo propio
+    std::future<std::string> ejecutarConsultaAsync(const std::string& consulta,
+                                                   Prioridad prioridad = PRIORIDAD_NORMAL) {
+        return Ejecutor::obtenerInstancia()->enviarConResultado(
+            [this, consulta] { return ejecutarConsulta(consulta); }, prioridad);
+    }
+    
     int obtenerEstadisticas() {
-        std::lock_guard<std::mutex> lock(mutexContador);
+        std::lock_guard<MutexPerfilado> lock(mutexContador);
         return consultasEjecutadas;
     }
     
+    void setLatenciaConsulta(std::shared_ptr<ModeloLatencia> modelo) {
+        latenciaConsulta.setModelo(modelo);
+    }
+    
+    void setLatenciaConexion(std::shared_ptr<ModeloLatencia> modelo) {
+        latenciaConectar.setModelo(modelo);
+    }
+    
+    // Se retira la instancia y se espera a las tareas del Ejecutor, que
+    // llevan su `this`, antes de borrarla
     static void destruirInstancia() {
-        std::lock_guard<std::mutex> lock(mutexInstancia);
-        if (instancia != nullptr) {
-            delete instancia;
-            instancia = nullptr;
+        ConexionBDThreadSafe* actual;
+        {
+            std::lock_guard<MutexPerfilado> lock(mutexInstancia);
+            actual = instancia.exchange(nullptr);
+        }
+        if (actual != nullptr) {
+            Ejecutor::drenarSiExiste();
+            delete actual;
         }
+        RegistroLocks* registro = RegistroLocks::obtenerInstancia();
+        if (registro->getReporteAlDestruir()) registro->imprimirReporte(std::cout, "ConexionBDThreadSafe");
     }
 };
 
-ConexionBDThreadSafe* ConexionBDThreadSafe::instancia = nullptr;
-std::mutex ConexionBDThreadSafe::mutexInstancia;
+std::atomic<ConexionBDThreadSafe*> ConexionBDThreadSafe::instancia(nullptr);
+MutexPerfilado ConexionBDThreadSafe::mutexInstancia("ConexionBDThreadSafe::mutexInstancia");
 
 #endif
@@ -1,37 +1,81 @@
 #ifndef LOGGERTHREADSAFE_H
 #define LOGGERTHREADSAFE_H
 
+#include <atomic>
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <cstdlib>
 #include <ctime>
 #include <mutex>
 #include <sstream>
+#include <unistd.h>
+#include "../comun/Traza.h"
+#include "MutexPerfilado.h"
+#include "BufferMapeado.h"
+#include "../comun/Ejecutor.h"
+#include "../comun/LimitadorLog.h"
+#include "../comun/Metricas.h"
 
 class LoggerThreadSafe {
 private:
-    static LoggerThreadSafe* instancia;
-    static std::mutex mutexInstancia;
-    std::mutex mutexEscritura;
+    static std::atomic<LoggerThreadSafe*> instancia;
+    static MutexPerfilado mutexInstancia;
+    MutexPerfilado mutexEscritura;
     std::string archivoLog;
     bool inicializado;
+    // Se consulta antes de formatear y de tomar mutexEscritura: una tormenta
+    // de errores desde un mismo sitio no llega al archivo
+    LimitadorLog limitador;
+    // Las líneas se copian a una ventana mapeada del archivo: sin write() por
+    // línea y sin perder lo ya escrito si el proceso cae
+    BufferMapeado buffer;
+    Contador metricaEscritas;
+    Contador metricaSuprimidas;
+    Histograma metricaEscritura;
     
-    LoggerThreadSafe() : archivoLog("bitacora_threadsafe.log"), inicializado(false) {}
+    LoggerThreadSafe() : mutexEscritura("LoggerThreadSafe::mutexEscritura"),
+                         archivoLog(std::getenv("LOG_ARCHIVO") != nullptr ? std::getenv("LOG_ARCHIVO")
+                                                                          : "bitacora_threadsafe.log"),
+                         inicializado(false),
+                         metricaEscritas("prac07_log_lineas_total{logger=\"LoggerThreadSafe\",resultado=\"escrita\"}",
+                                         "Líneas de log escritas o descartadas por el límite de frecuencia"),
+                         metricaSuprimidas("prac07_log_lineas_total{logger=\"LoggerThreadSafe\",resultado=\"suprimida\"}",
+                                           "Líneas de log escritas o descartadas por el límite de frecuencia"),
+                         metricaEscritura("prac07_log_escritura_segundos{logger=\"LoggerThreadSafe\"}",
+                                          "Duración de formatear y escribir una línea admitida") {}
+    
+    ~LoggerThreadSafe() {
+        unsigned long pendientes = limitador.pendientes();
+        if (pendientes == 0) return;
+        std::stringstream linea;
+        linea << "[" << obtenerTimestamp() << "] [INFO] " << pendientes
+              << " mensajes repetidos suprimidos sin resumir\n";
+        anexar(linea.str());
+    }
     
     LoggerThreadSafe(const LoggerThreadSafe&) = delete;
     LoggerThreadSafe& operator=(const LoggerThreadSafe&) = delete;
     
     void inicializar() {
         if (!inicializado) {
-            std::lock_guard<std::mutex> lock(mutexEscritura);
+            std::lock_guard<MutexPerfilado> lock(mutexEscritura);
             if (!inicializado) {
-                std::ofstream archivo(archivoLog, std::ios::app);
-                if (archivo.is_open()) {
-                    archivo << "\n" << std::string(80, '=') << "\n";
-                    archivo << "NUEVA SESIÓN (THREAD-SAFE) - " << obtenerTimestamp() << "\n";
-                    archivo << std::string(80, '=') << "\n";
-                    archivo.close();
+                if (!buffer.abrir(archivoLog) && buffer.getOcupado()) {
+                    // Otro proceso tiene mapeada la bitácora: este usa la suya
+                    std::stringstream propio;
+                    propio << archivoLog << "." << getpid();
+                    std::cout << "⚠️  " << archivoLog << " está en uso por otro proceso; se escribe en "
+                              << propio.str() << "\n";
+                    archivoLog = propio.str();
+                    buffer.abrir(archivoLog);
                 }
+                if (buffer.abierto()) BufferMapeado::instalarManejadorCaidas();
+                std::stringstream cabecera;
+                cabecera << "\n" << std::string(80, '=') << "\n";
+                cabecera << "NUEVA SESIÓN (THREAD-SAFE) - " << obtenerTimestamp() << "\n";
+                cabecera << std::string(80, '=') << "\n";
+                anexar(cabecera.str());
                 inicializado = true;
             }
         }
@@ -41,52 +85,113 @@ private:
         time_t ahora = time(0);
         struct tm tstruct;
         char buf[80];
-        tstruct = *localtime(&ahora);
+        localtime_r(&ahora, &tstruct);
         strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tstruct);
         return buf;
     }
 
+    void escribir(const std::string& mensaje, const std::string& nivel, unsigned long repetidas) {
+        TRAZA_SPAN("LoggerThreadSafe::log", "log");
+        CronometroMetrica cronometro(metricaEscritura);
+        metricaEscritas.incrementar();
+        std::string timestamp = obtenerTimestamp();
+        std::stringstream lineaLog;
+        lineaLog << "[" << timestamp << "] [" << nivel << "] " << mensaje;
+        if (repetidas > 0) lineaLog << " [mensaje repetido " << repetidas << " veces]";
+        
+        lineaLog << "\n";
+        std::string linea = lineaLog.str();
+        
+        // Proteger la escritura con mutex
+        LockTrazado<MutexPerfilado> lock(mutexEscritura, "espera mutexEscritura");
+        anexar(linea);
+        std::cout << linea;
+    }
+    
+    // Llamar con mutexEscritura tomado. Si el archivo no se pudo abrir con
+    // BufferMapeado (p. ej. sistema de archivos que no lo admite) se vuelve a
+    // abrir en cada línea; si lo que falla es una ventana posterior, el propio
+    // buffer sigue con pwrite().
+    void anexar(const std::string& linea) {
+        if (buffer.escribir(linea.data(), linea.size())) return;
+        std::ofstream archivo(archivoLog, std::ios::app);
+        if (archivo.is_open()) archivo << linea;
+    }
+
 public:
     static LoggerThreadSafe* obtenerInstancia() {
-        // Primera verificación sin lock (rápida)
-        if (instancia == nullptr) {
+        // Primera verificación sin lock (rápida). El acquire empareja con el
+        // release de abajo: quien ve el puntero ve el objeto ya inicializado.
+        LoggerThreadSafe* actual = instancia.load(std::memory_order_acquire);
+        if (actual == nullptr) {
             // Lock solo si necesitamos crear la instancia
-            std::lock_guard<std::mutex> lock(mutexInstancia);
+            std::lock_guard<MutexPerfilado> lock(mutexInstancia);
             // Segunda verificación con lock (segura)
-            if (instancia == nullptr) {
+            actual = instancia.load(std::memory_order_relaxed);
+            if (actual == nullptr) {
                 std::cout << "🔧 Creando nueva instancia de LoggerThreadSafe...\n";
-                instancia = new LoggerThreadSafe();
-                instancia->inicializar();
+                actual = new LoggerThreadSafe();
+                actual->inicializar();
+                instancia.store(actual, std::memory_order_release);
             }
         }
-        return instancia;
+        return actual;
     }
     
-    void log(const std::string& mensaje, const std::string& nivel = "INFO") {
-        std::string timestamp = obtenerTimestamp();
-        std::stringstream lineaLog;
-        lineaLog << "[" << timestamp << "] [" << nivel << "] " << mensaje;
-        
-        // Proteger la escritura con mutex
-        std::lock_guard<std::mutex> lock(mutexEscritura);
-        std::ofstream archivo(archivoLog, std::ios::app);
-        if (archivo.is_open()) {
-            archivo << lineaLog.str() << "\n";
-            archivo.close();
+    void log(const std::string& mensaje, const std::string& nivel = "INFO", SitioLog sitio = SitioLog()) {
+        unsigned long repetidas;
+        if (!limitador.admitir(LimitadorLog::clave(sitio, nivel, mensaje), repetidas)) {
+            metricaSuprimidas.incrementar();
+            return;
+        }
+        escribir(mensaje, nivel, repetidas);
+    }
+    
+    // Delega la escritura al Ejecutor con prioridad baja. El timestamp se toma
+    // al llamar; entre hilos distintos el orden en el archivo no está garantizado.
+    // El límite de frecuencia se aplica aquí, así lo suprimido ni se encola.
+    void logAsync(const std::string& mensaje, const std::string& nivel = "INFO", SitioLog sitio = SitioLog()) {
+        unsigned long repetidas;
+        if (!limitador.admitir(LimitadorLog::clave(sitio, nivel, mensaje), repetidas)) {
+            metricaSuprimidas.incrementar();
+            return;
         }
-        std::cout << lineaLog.str() << "\n";
+        std::string conMarca = "(" + obtenerTimestamp() + ") " + mensaje;
+        Ejecutor::obtenerInstancia()->enviar([this, conMarca, nivel, repetidas] {
+            escribir(conMarca, nivel, repetidas);
+        }, PRIORIDAD_BAJA);
+    }
+    
+    void error(const std::string& mensaje, SitioLog sitio = SitioLog()) {
+        log(mensaje, "ERROR", sitio);
     }
     
+    // Ráfaga y líneas por segundo por sitio de llamada; rafaga = 0 lo desactiva
+    void setLimiteFrecuencia(double rafaga, double porSegundo) {
+        limitador.configurar(rafaga, porSegundo);
+    }
+    
+    unsigned long getLineasEscritas() const { return limitador.getAdmitidas(); }
+    unsigned long getLineasSuprimidas() const { return limitador.getSuprimidas(); }
+    
+    // Se retira la instancia y se espera a las tareas del Ejecutor, que
+    // llevan su `this`, antes de borrarla
     static void destruirInstancia() {
-        std::lock_guard<std::mutex> lock(mutexInstancia);
-        if (instancia != nullptr) {
-            delete instancia;
-            instancia = nullptr;
+        LoggerThreadSafe* actual;
+        {
+            std::lock_guard<MutexPerfilado> lock(mutexInstancia);
+            actual = instancia.exchange(nullptr);
+        }
+        if (actual != nullptr) {
+            Ejecutor::drenarSiExiste();
+            delete actual;
         }
+        RegistroLocks* registro = RegistroLocks::obtenerInstancia();
+        if (registro->getReporteAlDestruir()) registro->imprimirReporte(std::cout, "LoggerThreadSafe");
     }
 };
 
-LoggerThreadSafe* LoggerThreadSafe::instancia = nullptr;
-std::mutex LoggerThreadSafe::mutexInstancia;
+std::atomic<LoggerThreadSafe*> LoggerThreadSafe::instancia(nullptr);
+MutexPerfilado LoggerThreadSafe::mutexInstancia("LoggerThreadSafe::mutexInstancia");
 
 #endif
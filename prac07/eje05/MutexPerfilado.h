@@ -0,0 +1,226 @@
+#ifndef MUTEXPERFILADO_H
+#define MUTEXPERFILADO_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Contadores de un lock con nombre. Varios mutex con el mismo nombre
+// (p. ej. el de cada instancia recreada) acumulan en las mismas estadísticas.
+struct EstadisticasLock {
+    std::atomic<uint64_t> adquisiciones;
+    std::atomic<uint64_t> contenciones;
+    std::atomic<uint64_t> esperaTotalNs;
+    std::atomic<uint64_t> esperaMaxNs;
+    std::atomic<uint64_t> retencionTotalNs;
+    std::atomic<uint64_t> retencionMaxNs;
+    std::atomic<uint64_t> resueltasGirando;
+    
+    EstadisticasLock() : adquisiciones(0), contenciones(0), esperaTotalNs(0), esperaMaxNs(0),
+                         retencionTotalNs(0), retencionMaxNs(0), resueltasGirando(0) {}
+    
+    static void actualizarMaximo(std::atomic<uint64_t>& maximo, uint64_t valor) {
+        uint64_t actual = maximo.load(std::memory_order_relaxed);
+        while (valor > actual &&
+               !maximo.compare_exchange_weak(actual, valor, std::memory_order_relaxed)) {}
+    }
+    
+    void reiniciar() {
+        adquisiciones = 0;
+        contenciones = 0;
+        esperaTotalNs = 0;
+        esperaMaxNs = 0;
+        retencionTotalNs = 0;
+        retencionMaxNs = 0;
+        resueltasGirando = 0;
+    }
+};
+
+// Registro global de locks perfilados (Singleton thread-safe). Con
+// PERFIL_LOCKS definida (o setReporteAlDestruir(true)) cada singleton de
+// eje05 imprime el reporte de sus locks en su destruirInstancia().
+class RegistroLocks {
+private:
+    static std::atomic<RegistroLocks*> instancia;
+    static std::mutex mutexInstancia;
+    
+    std::mutex mutexRegistro;
+    std::map<std::string, std::shared_ptr<EstadisticasLock> > locks;
+    bool reporteAlDestruir;
+    
+    RegistroLocks() : reporteAlDestruir(std::getenv("PERFIL_LOCKS") != nullptr) {}
+    
+    RegistroLocks(const RegistroLocks&) = delete;
+    RegistroLocks& operator=(const RegistroLocks&) = delete;
+
+public:
+    static RegistroLocks* obtenerInstancia() {
+        RegistroLocks* actual = instancia.load(std::memory_order_acquire);
+        if (actual == nullptr) {
+            std::lock_guard<std::mutex> lock(mutexInstancia);
+            actual = instancia.load(std::memory_order_relaxed);
+            if (actual == nullptr) {
+                actual = new RegistroLocks();
+                instancia.store(actual, std::memory_order_release);
+            }
+        }
+        return actual;
+    }
+    
+    std::shared_ptr<EstadisticasLock> registrar(const std::string& nombre) {
+        std::lock_guard<std::mutex> lock(mutexRegistro);
+        std::shared_ptr<EstadisticasLock>& e = locks[nombre];
+        if (!e) e = std::make_shared<EstadisticasLock>();
+        return e;
+    }
+    
+    void setReporteAlDestruir(bool valor) { reporteAlDestruir = valor; }
+    bool getReporteAlDestruir() const { return reporteAlDestruir; }
+    
+    // Reporte de los locks cuyo nombre empieza por 'prefijo' (todos si vacío)
+    void imprimirReporte(std::ostream& salida = std::cout, const std::string& prefijo = "") {
+        std::lock_guard<std::mutex> lock(mutexRegistro);
+        salida << "\n" << std::string(100, '=') << "\n";
+        salida << "🔒 CONTENCIÓN DE LOCKS" << (prefijo.empty() ? "" : " (" + prefijo + ")") << "\n";
+        salida << std::string(100, '=') << "\n";
+        // setw cuenta bytes: se compensan los caracteres UTF-8 de la cabecera
+        salida << std::left << std::setw(40) << "Lock" << std::right
+               << std::setw(10) << "Adquis." << std::setw(10) << "Conten."
+               << std::setw(8) << "Giro"
+               << std::setw(14) << "Espera μs" << std::setw(15) << "Esp.máx μs"
+               << std::setw(16) << "Retención μs" << "\n";
+        for (std::map<std::string, std::shared_ptr<EstadisticasLock> >::const_iterator it = locks.begin();
+             it != locks.end(); ++it) {
+            if (it->first.compare(0, prefijo.size(), prefijo) != 0) continue;
+            const EstadisticasLock& e = *it->second;
+            salida << std::left << std::setw(40) << it->first << std::right
+                   << std::setw(10) << e.adquisiciones.load()
+                   << std::setw(10) << e.contenciones.load()
+                   << std::setw(8) << e.resueltasGirando.load()
+                   << std::setw(13) << std::fixed << std::setprecision(1) << e.esperaTotalNs.load() / 1000.0
+                   << std::setw(13) << e.esperaMaxNs.load() / 1000.0
+                   << std::setw(14) << e.retencionTotalNs.load() / 1000.0 << "\n";
+        }
+        salida << std::string(100, '=') << "\n";
+    }
+    
+    void reiniciar() {
+        std::lock_guard<std::mutex> lock(mutexRegistro);
+        for (std::map<std::string, std::shared_ptr<EstadisticasLock> >::iterator it = locks.begin();
+             it != locks.end(); ++it) {
+            it->second->reiniciar();
+        }
+    }
+    
+    static void destruirInstancia() {
+        std::lock_guard<std::mutex> lock(mutexInstancia);
+        RegistroLocks* actual = instancia.exchange(nullptr);
+        delete actual;
+    }
+};
+
+std::atomic<RegistroLocks*> RegistroLocks::instancia(nullptr);
+std::mutex RegistroLocks::mutexInstancia;
+
+// Mutex instrumentado (BasicLockable: sirve con std::lock_guard). Mide la
+// espera para adquirirlo, el tiempo retenido y cuántas adquisiciones
+// encontraron el lock ocupado.
+//
+// Con 'adaptativo' activo, ante contención gira un número de intentos antes
+// de dormir en el mutex del sistema. El límite de giros se adapta a cuántos
+// hicieron falta en las últimas esperas: útil en secciones críticas muy
+// cortas (el incremento de un contador), contraproducente en las largas.
+class MutexPerfilado {
+private:
+    static const int32_t GIROS_MAX = 2000;
+    
+    std::mutex mutex;
+    std::shared_ptr<EstadisticasLock> estadisticas;
+    bool adaptativo;
+    std::atomic<int32_t> girosEstimados;
+    std::chrono::steady_clock::time_point inicioRetencion;   // solo lo toca el dueño
+    
+    static uint64_t nanosDesde(std::chrono::steady_clock::time_point t) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - t).count());
+    }
+    
+    static void pausaCPU() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#else
+        std::this_thread::yield();
+#endif
+    }
+    
+    bool girar() {
+        int32_t limite = std::min(GIROS_MAX, girosEstimados.load(std::memory_order_relaxed) * 2 + 10);
+        for (int32_t i = 0; i < limite; i++) {
+            pausaCPU();
+            if (mutex.try_lock()) {
+                // Media móvil de los giros necesarios
+                int32_t previo = girosEstimados.load(std::memory_order_relaxed);
+                girosEstimados.store(previo + (i - previo) / 8, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        int32_t previo = girosEstimados.load(std::memory_order_relaxed);
+        girosEstimados.store(previo - previo / 8, std::memory_order_relaxed);
+        return false;
+    }
+
+public:
+    explicit MutexPerfilado(const std::string& nombre, bool esAdaptativo = false)
+        : estadisticas(RegistroLocks::obtenerInstancia()->registrar(nombre)),
+          adaptativo(esAdaptativo && std::thread::hardware_concurrency() > 1),
+          girosEstimados(100) {}
+    
+    MutexPerfilado(const MutexPerfilado&) = delete;
+    MutexPerfilado& operator=(const MutexPerfilado&) = delete;
+    
+    void lock() {
+        if (!mutex.try_lock()) {
+            std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+            if (adaptativo && girar()) {
+                estadisticas->resueltasGirando.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                mutex.lock();
+            }
+            uint64_t espera = nanosDesde(inicio);
+            estadisticas->contenciones.fetch_add(1, std::memory_order_relaxed);
+            estadisticas->esperaTotalNs.fetch_add(espera, std::memory_order_relaxed);
+            EstadisticasLock::actualizarMaximo(estadisticas->esperaMaxNs, espera);
+        }
+        estadisticas->adquisiciones.fetch_add(1, std::memory_order_relaxed);
+        inicioRetencion = std::chrono::steady_clock::now();
+    }
+    
+    bool try_lock() {
+        if (!mutex.try_lock()) return false;
+        estadisticas->adquisiciones.fetch_add(1, std::memory_order_relaxed);
+        inicioRetencion = std::chrono::steady_clock::now();
+        return true;
+    }
+    
+    void unlock() {
+        uint64_t retencion = nanosDesde(inicioRetencion);
+        mutex.unlock();
+        estadisticas->retencionTotalNs.fetch_add(retencion, std::memory_order_relaxed);
+        EstadisticasLock::actualizarMaximo(estadisticas->retencionMaxNs, retencion);
+    }
+    
+    const EstadisticasLock& getEstadisticas() const { return *estadisticas; }
+};
+
+const int32_t MutexPerfilado::GIROS_MAX;
+
+#endif
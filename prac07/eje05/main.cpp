@@ -3,9 +3,17 @@
 #include <thread>
 #include <vector>
 #include <chrono>
+#include <future>
+#include <fstream>
+#include <cstdlib>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 void pruebaLoggerConcurrente(int idTrabajador, int numMensajes) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(idTrabajador * 100));
+    EntornoLatencia* entorno = EntornoLatencia::obtenerInstancia();
+    entorno->pausa(std::chrono::milliseconds(idTrabajador * 100));
     
     LoggerThreadSafe* logger = LoggerThreadSafe::obtenerInstancia();
     std::cout << "👤 Trabajador " << idTrabajador << " obtuvo logger: " << logger << "\n";
@@ -13,12 +21,13 @@ void pruebaLoggerConcurrente(int idTrabajador, int numMensajes) {
     for (int i = 0; i < numMensajes; i++) {
         logger->log("Trabajador " + std::to_string(idTrabajador) + 
                    " - Mensaje " + std::to_string(i+1), "INFO");
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        entorno->pausa(std::chrono::milliseconds(50));
     }
 }
 
 void pruebaBDConcurrente(int idTrabajador, int numConsultas) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(idTrabajador * 100));
+    EntornoLatencia* entorno = EntornoLatencia::obtenerInstancia();
+    entorno->pausa(std::chrono::milliseconds(idTrabajador * 100));
     
     ConexionBDThreadSafe* bd = ConexionBDThreadSafe::obtenerInstancia();
     std::cout << "👤 Trabajador " << idTrabajador << " obtuvo BD: " << bd << "\n";
@@ -26,11 +35,61 @@ void pruebaBDConcurrente(int idTrabajador, int numConsultas) {
     for (int i = 0; i < numConsultas; i++) {
         bd->ejecutarConsulta("SELECT * FROM tabla_" + std::to_string(idTrabajador) + 
                             " WHERE id=" + std::to_string(i));
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        entorno->pausa(std::chrono::milliseconds(100));
     }
 }
 
-int main() {
+// Proceso hijo de la prueba 5: escribe en su propia bitácora y aborta sin
+// destruir el logger. Lo que quede en el archivo es lo que salvó el mapeo.
+void procesoQueCae(int numLineas) {
+    struct rlimit sinCore = {0, 0};
+    setrlimit(RLIMIT_CORE, &sinCore);
+    LoggerThreadSafe* logger = LoggerThreadSafe::obtenerInstancia();
+    for (int i = 1; i <= numLineas; i++) {
+        logger->log("Caída simulada - línea " + std::to_string(i), "INFO");
+    }
+    std::abort();
+}
+
+// Lanza este mismo ejecutable con --caida y revisa la bitácora que deja
+void pruebaCaida(int numLineas) {
+    const char* archivo = "bitacora_caida.log";
+    unlink(archivo);
+    pid_t hijo = fork();
+    if (hijo == 0) {
+        int nulo = open("/dev/null", O_WRONLY);
+        if (nulo >= 0) dup2(nulo, STDOUT_FILENO);
+        setenv("LOG_ARCHIVO", archivo, 1);
+        std::string lineas = std::to_string(numLineas);
+        execl("/proc/self/exe", "singleton_threadsafe", "--caida", lineas.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    int estado = 0;
+    waitpid(hijo, &estado, 0);
+    if (WIFSIGNALED(estado)) {
+        std::cout << "💥 El hijo terminó por la señal " << WTERMSIG(estado) << " sin cerrar el logger\n";
+    }
+    
+    std::ifstream bitacora(archivo);
+    std::string linea, penultima, ultima;
+    int recuperadas = 0;
+    while (std::getline(bitacora, linea)) {
+        if (linea.find("Caída simulada") != std::string::npos) recuperadas++;
+        penultima = ultima;
+        ultima = linea;
+    }
+    std::cout << "📄 Líneas recuperadas de " << archivo << ": " << recuperadas << "/" << numLineas << "\n";
+    std::cout << "   " << penultima << "\n   " << ultima << "\n";
+    unlink(archivo);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 2 && std::string(argv[1]) == "--caida") {
+        procesoQueCae(std::atoi(argv[2]));
+    }
+    
+    RegistroLocks::obtenerInstancia()->setReporteAlDestruir(true);
+    
     std::cout << std::string(80, '=') << "\n";
     std::cout << "EJERCICIO 05: SINGLETON THREAD-SAFE\n";
     std::cout << std::string(80, '=') << "\n";
@@ -83,6 +142,72 @@ int main() {
     std::cout << "\n📊 ESTADÍSTICAS FINALES:\n";
     std::cout << "   Total de consultas ejecutadas: " << bdPrincipal->obtenerEstadisticas() << "\n";
     
+    // ========== PRUEBA 3: Ejecutor compartido ==========
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "PRUEBA 3: EJECUTOR COMPARTIDO CON PRIORIDADES\n";
+    std::cout << std::string(80, '=') << "\n";
+    
+    Ejecutor* ejecutor = Ejecutor::obtenerInstancia();
+    std::cout << "\n🧵 Ejecutor con " << ejecutor->getNumHilos() << " hilos trabajadores\n";
+    
+    LoggerThreadSafe* loggerAsync = LoggerThreadSafe::obtenerInstancia();
+    std::vector<std::future<std::string>> resultados;
+    
+    for (int i = 0; i < 6; i++) {
+        Prioridad prioridad = (i % 3 == 0) ? PRIORIDAD_ALTA : PRIORIDAD_NORMAL;
+        resultados.push_back(bdPrincipal->ejecutarConsultaAsync(
+            "SELECT * FROM pedidos WHERE lote=" + std::to_string(i), prioridad));
+        loggerAsync->logAsync("Consulta asíncrona " + std::to_string(i) + " encolada", "DEBUG");
+    }
+    
+    for (size_t i = 0; i < resultados.size(); i++) {
+        std::cout << "   📦 Resultado " << i << ": " << resultados[i].get() << "\n";
+    }
+    ejecutor->drenar();
+    
+    std::cout << "\n📊 Tareas ejecutadas: " << ejecutor->getEjecutadas()
+              << " (robadas entre colas: " << ejecutor->getRobadas() << ")\n";
+    std::cout << "   Total de consultas ejecutadas: " << bdPrincipal->obtenerEstadisticas() << "\n";
+    
+    // ========== PRUEBA 4: Tormenta de errores ==========
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "PRUEBA 4: TORMENTA DE ERRORES CON LÍMITE POR SITIO\n";
+    std::cout << std::string(80, '=') << "\n\n";
+    
+    const int erroresPorHilo = 5000;
+    unsigned long escritasAntes = loggerAsync->getLineasEscritas();
+    unsigned long suprimidasAntes = loggerAsync->getLineasSuprimidas();
+    std::chrono::steady_clock::time_point inicioTormenta = std::chrono::steady_clock::now();
+    std::vector<std::thread> hilosTormenta;
+    for (int i = 0; i < numHilos; i++) {
+        hilosTormenta.emplace_back([loggerAsync, i] {
+            for (int j = 0; j < erroresPorHilo; j++) {
+                loggerAsync->error("Trabajador " + std::to_string(i + 1) + ": timeout al leer pedidos",
+                                   LOG_SITIO);
+            }
+        });
+    }
+    for (auto& hilo : hilosTormenta) hilo.join();
+    double msTormenta = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - inicioTormenta).count();
+    
+    std::cout << "\n🌩️  " << numHilos * erroresPorHilo << " errores desde " << numHilos
+              << " hilos en " << msTormenta << " ms\n";
+    std::cout << "   Líneas escritas: " << loggerAsync->getLineasEscritas() - escritasAntes
+              << ", suprimidas: " << loggerAsync->getLineasSuprimidas() - suprimidasAntes << "\n";
+    
+    // ========== PRUEBA 5: Caída del proceso ==========
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "PRUEBA 5: CAÍDA CON BITÁCORA MAPEADA EN MEMORIA\n";
+    std::cout << std::string(80, '=') << "\n\n";
+    pruebaCaida(2000);
+    
+    // ========== PRUEBA 6: Métricas ==========
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "PRUEBA 6: MÉTRICAS (METRICAS_PUERTO / METRICAS_ARCHIVO para exportarlas)\n";
+    std::cout << std::string(80, '=') << "\n\n";
+    RegistroMetricas::obtenerInstancia()->imprimirResumen();
+    
     // ========== VERIFICACIÓN FINAL ==========
     std::cout << "\n" << std::string(80, '=') << "\n";
     std::cout << "VERIFICACIÓN DE INSTANCIA ÚNICA\n";
@@ -116,8 +241,15 @@ int main() {
     std::cout << "✅ Solo se crea una instancia incluso con múltiples hilos simultáneos\n";
     std::cout << std::string(80, '=') << "\n";
     
+    // Se destruyen con escrituras aún en el Ejecutor: esperan a que terminen
+    for (int i = 0; i < 5; i++) loggerAsync->logAsync("Cierre con escritura pendiente " + std::to_string(i + 1));
     LoggerThreadSafe::destruirInstancia();
     ConexionBDThreadSafe::destruirInstancia();
+    Ejecutor::destruirInstancia();
+    EntornoLatencia::destruirInstancia();
+    Rastreador::destruirInstancia();
+    RegistroLocks::destruirInstancia();
+    RegistroMetricas::destruirInstancia();
     
     return 0;
 }